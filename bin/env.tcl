@@ -3,4 +3,5 @@
 export DASS=/scratch/jc9016/shared/dass
 export CLANG=$DASS/llvm/build/bin/clang
 export OPT=$DASS/llvm/build/bin/opt
+export DASS_DRIVER=$DASS/dass/build/Driver/dass-driver
 set -e -o xtrace
@@ -819,7 +819,7 @@ void BoogieCodeGenerator::analyzeLoop(std::string loopName) {
       memoryAnalysisRegions.push_back(&*BB);
 }
 
-static void declareVariable(Value *var, std::fstream &bpl) {
+static void declareVariable(Value *var, std::ostream &bpl) {
   if (var->getType()->isIntegerTy()) {
     if (var->getType()->isPointerTy())
       bpl << "\tvar " << getVariableNameInBoogie(var)
@@ -1242,4 +1242,33 @@ void BoogieCodeGenerator::generateMainForLoopInterchange(int distance) {
       << "address_0 != address_1;\n ";
 
   bpl << "}\n";
-}
\ No newline at end of file
+}
+
+void BoogieCodeGenerator::generateLoopAnalysis() {
+  // Start from scratch, so that the statement labels do not depend on the
+  // loops analyzed before
+  phis.clear();
+  invariances.clear();
+  arrays.clear();
+  accesses.clear();
+  bpl.str("");
+
+  generateBoogieHeader();
+  phiAnalysis();
+
+  // Generating top-level function
+  generateFuncPrototype(true);
+  generateVariableDeclarations();
+  generateFunctionBody(true);
+  loopAnalysis = bpl.str();
+}
+
+void BoogieCodeGenerator::generateLoopInterchangeCheck(std::string file,
+                                                       int distance) {
+  assert(!loopAnalysis.empty() && "Loop analysis not generated");
+  bpl.str("");
+  generateMainForLoopInterchange(distance);
+  std::ofstream ofile(file);
+  ofile << loopAnalysis << bpl.str();
+  ofile.close();
+}
@@ -6,11 +6,17 @@
 
 #include <cassert>
 #include <fstream>
+#include <map>
+#include <omp.h>
+#include <sstream>
+#include <unistd.h>
 
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
@@ -22,6 +28,24 @@ static cl::opt<int> opt_upper("upperbound", cl::desc("Upper bound of search"),
                               cl::Hidden, cl::init(10), cl::Optional);
 static cl::opt<int> opt_lower("lowerbound", cl::desc("Lower bound of search"),
                               cl::Hidden, cl::init(1), cl::Optional);
+static cl::opt<int>
+    opt_jobs("verify-jobs",
+             cl::desc("Number of verification jobs to run in parallel, 0 to "
+                      "use all the processors"),
+             cl::Hidden, cl::init(0), cl::Optional);
+static cl::opt<std::string>
+    opt_solver("boogie-cmd",
+               cl::desc("Command to verify a Boogie program, called with the "
+                        ".bpl file as the last argument"),
+               cl::Hidden, cl::init("boogie"), cl::Optional);
+static cl::opt<std::string>
+    opt_cacheDir("boogie-cache",
+                 cl::desc("Directory of the cached verification results, "
+                          "empty to always run the solver"),
+                 cl::Hidden, cl::init("./.boogie_cache"), cl::Optional);
+
+// Bump when the meaning of a cached result changes
+static const std::string cacheVersion = "1";
 
 //--------------------------------------------------------//
 // Pass declaration: LoopInterchangeCheckPass
@@ -117,27 +141,97 @@ static bool isVerificationSuccess(std::string fname) {
   return true;
 }
 
-static bool verifyLoopInterchangeDepth(std::string loopName,
-                                       BoogieCodeGenerator &bcg, int depth) {
-  auto fname = "./verify_" + loopName + ".bpl";
-  bcg.open(fname);
-  bcg.generateBoogieHeader();
-  bcg.phiAnalysis();
-
-  // Generating top-level function
-  bcg.generateFuncPrototype(true);
-  bcg.generateVariableDeclarations();
-  bcg.generateFunctionBody(true);
-  bcg.generateMainForLoopInterchange(depth);
-  bcg.close();
-
-  // Run verification Boogie
-  llvm::errs() << "Checking " << loopName
-               << " with interchanging depth = " << depth << ": ";
-  system(std::string("boogie " + fname + " 2>&1 | tee ./boogie.log").c_str());
-  auto isSuccess = isVerificationSuccess("./boogie.log");
-  if (isSuccess)
-    system(std::string("rm " + fname + " " + "./boogie.log").c_str());
+// The Boogie program and the log of each depth have their own files, so the
+// jobs can run concurrently
+static std::string getBoogieFileName(std::string loopName, int depth) {
+  return "./verify_" + loopName + "_" + std::to_string(depth);
+}
+
+// The generated program encodes the loop, the depth and the code generator,
+// so it is hashed with the solver as the key of the cached result
+static std::string getCacheKey(std::string bplFile) {
+  std::ifstream bpl(bplFile);
+  std::stringstream buffer;
+  buffer << bpl.rdbuf();
+
+  MD5 hash;
+  hash.update(cacheVersion);
+  hash.update(opt_solver);
+  hash.update(buffer.str());
+  MD5::MD5Result result;
+  hash.final(result);
+  return opt_cacheDir + "/" + result.digest().str().str();
+}
+
+// Returns -1 if the program is not cached
+static int getCachedResult(std::string key) {
+  std::ifstream entry(key);
+  std::string result;
+  if (!entry.is_open() || !std::getline(entry, result))
+    return -1;
+  return (result == "success") ? 1 : 0;
+}
+
+static void cacheResult(std::string key, bool isSuccess) {
+  // Write and rename, so concurrent runs never read a partial entry
+  auto tmp = key + "." + std::to_string(getpid());
+  std::ofstream entry(tmp);
+  entry << (isSuccess ? "success" : "failed") << "\n";
+  entry.close();
+  sys::fs::rename(tmp, key);
+}
+
+// Verify the given depths with a pool of solver processes. Returns the
+// result of each depth.
+static std::map<int, bool> verifyLoopInterchangeDepths(
+    std::string loopName, BoogieCodeGenerator &bcg, std::vector<int> depths) {
+  bool useCache = !opt_cacheDir.empty();
+  if (useCache)
+    sys::fs::create_directories(opt_cacheDir);
+
+  // The code generator is not thread safe, only the solvers run in parallel
+  std::vector<std::string> keys(depths.size());
+  std::vector<int> results(depths.size(), -1);
+  std::vector<char> isCached(depths.size(), false);
+  for (unsigned i = 0; i < depths.size(); i++) {
+    auto fname = getBoogieFileName(loopName, depths[i]) + ".bpl";
+    bcg.generateLoopInterchangeCheck(fname, depths[i]);
+    if (useCache) {
+      keys[i] = getCacheKey(fname);
+      results[i] = getCachedResult(keys[i]);
+      isCached[i] = (results[i] != -1);
+    }
+  }
+
+  int jobs = (opt_jobs > 0) ? opt_jobs : omp_get_num_procs();
+#pragma omp parallel for num_threads(jobs) schedule(dynamic)
+  for (unsigned i = 0; i < depths.size(); i++) {
+    if (isCached[i])
+      continue;
+    auto fname = getBoogieFileName(loopName, depths[i]);
+    auto status = system(std::string(opt_solver + " " + fname + ".bpl > " +
+                                     fname + ".log 2>&1")
+                             .c_str());
+    results[i] = isVerificationSuccess(fname + ".log");
+    // Do not remember the runs where the solver itself did not complete
+    if (useCache && (status == 0 || !results[i]))
+      cacheResult(keys[i], results[i]);
+  }
+
+  std::map<int, bool> isSuccess;
+  for (unsigned i = 0; i < depths.size(); i++) {
+    auto fname = getBoogieFileName(loopName, depths[i]);
+    llvm::errs() << "Checking " << loopName
+                 << " with interchanging depth = " << depths[i] << ": "
+                 << (results[i] ? "success" : "failed")
+                 << (isCached[i] ? " (cached)" : "") << "\n";
+    // Keep the failed programs for debugging
+    if (results[i])
+      system(std::string("rm -f " + fname + ".bpl " + fname + ".log").c_str());
+    else if (!isCached[i])
+      llvm::errs() << "See " << fname << ".log\n";
+    isSuccess[depths[i]] = results[i];
+  }
   return isSuccess;
 }
 
@@ -149,9 +243,10 @@ static void checkLoopInterchangeDepth(Loop *loop, BoogieCodeGenerator &bcg) {
 
   auto loopName = getLoopDASSName(loop);
   bcg.analyzeLoop(loopName);
+  bcg.generateLoopAnalysis();
 
   if (depth != -1) {
-    if (verifyLoopInterchangeDepth(loopName, bcg, depth))
+    if (verifyLoopInterchangeDepths(loopName, bcg, {depth})[depth])
       transform(loop, depth);
     else
       llvm_unreachable("Boogie verification failed.\n");
@@ -166,13 +261,32 @@ static void checkLoopInterchangeDepth(Loop *loop, BoogieCodeGenerator &bcg) {
         "upperbound values.");
   }
 
-  for (int i = opt_lower; i <= opt_upper; i++)
-    if (!verifyLoopInterchangeDepth(loopName, bcg, i)) {
-      llvm::errs() << "Found interchanging depth for " << loopName << " : "
-                   << i - 1 << "\n";
-      transform(loop, i - 1);
-      break;
-    }
+  // Search for the first depth that fails in [lowerbound, upperbound]. An
+  // interchange that is valid for a depth is also valid for the smaller
+  // depths, so each round verifies a few depths evenly spaced in the range
+  // still unknown, one per job, and narrows the range to the interval between
+  // the last success and the first failure. With one job this is a bisection.
+  int jobs = (opt_jobs > 0) ? opt_jobs : omp_get_num_procs();
+  int lo = opt_lower - 1, hi = opt_upper + 1;
+  while (hi - lo > 1) {
+    std::vector<int> depths;
+    int count = std::min(jobs, hi - lo - 1);
+    for (int i = 1; i <= count; i++)
+      depths.push_back(lo + (long)(hi - lo) * i / (count + 1));
+    auto results = verifyLoopInterchangeDepths(loopName, bcg, depths);
+    for (auto d : depths)
+      if (!results[d]) {
+        hi = d;
+        break;
+      } else
+        lo = d;
+  }
+
+  if (hi <= opt_upper) {
+    llvm::errs() << "Found interchanging depth for " << loopName << " : "
+                 << hi - 1 << "\n";
+    transform(loop, hi - 1);
+  }
   return;
 }
 
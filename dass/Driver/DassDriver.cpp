@@ -0,0 +1,133 @@
+//--------------------------------------------------------//
+// Tool: dass-driver
+// Run a list of DASS passes on one LLVM module in a single process. The
+// scripts used to start a new opt for every pass, which parses and verifies
+// the same IR and loads the same plugins each time. Here they are loaded and
+// parsed once. Each stage still runs on a fresh copy of the parsed module, as
+// if it was read from the file, because the passes rewrite the IR as a side
+// effect of synthesis and expect the original program. The time spent in
+// each stage is reported at the end.
+//
+// e.g. dass-driver -load libSynthesis.so
+//        -stages=ss-wrapper-gen,dass-vhdl-rewrite,collect-ss-rtl
+//        kernel.ll -top=kernel ...
+//--------------------------------------------------------//
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/LinkAllIR.h"
+#include "llvm/LinkAllPasses.h"
+#include "llvm/Pass.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/PluginLoader.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+#ifdef LINK_POLLY_INTO_TOOLS
+namespace polly {
+void initializePollyPasses(llvm::PassRegistry &Registry);
+}
+#endif
+
+static cl::opt<std::string> opt_input(cl::Positional,
+                                      cl::desc("<input bitcode file>"),
+                                      cl::Required);
+
+static cl::list<std::string>
+    opt_stages("stages", cl::desc("Comma separated list of passes to run"),
+               cl::CommaSeparated, cl::OneOrMore);
+
+static cl::opt<bool>
+    opt_shareModule("share-module",
+                    cl::desc("Run all the stages on the same module instead "
+                             "of a fresh copy of the input"),
+                    cl::init(false));
+
+typedef std::chrono::steady_clock Clock;
+
+static double getElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  // The DASS and Dynamatic passes depend on the LLVM analyses, so register
+  // the same passes as opt
+  auto &registry = *PassRegistry::getPassRegistry();
+  initializeCore(registry);
+  initializeScalarOpts(registry);
+  initializeIPO(registry);
+  initializeAnalysis(registry);
+  initializeTransformUtils(registry);
+  initializeInstCombine(registry);
+  initializeTarget(registry);
+#ifdef LINK_POLLY_INTO_TOOLS
+  polly::initializePollyPasses(registry);
+#endif
+
+  cl::ParseCommandLineOptions(argc, argv, "DASS pass pipeline driver\n");
+
+  std::vector<std::pair<std::string, double>> timings;
+  auto start = Clock::now();
+
+  LLVMContext context;
+  SMDiagnostic err;
+  auto module = parseIRFile(opt_input, err, context);
+  if (!module) {
+    err.print(argv[0], errs());
+    return 1;
+  }
+  if (verifyModule(*module, &errs())) {
+    errs() << argv[0] << ": " << opt_input << ": input module is broken!\n";
+    return 1;
+  }
+  timings.push_back({"parse", getElapsedMs(start)});
+
+  // Check all the stages before running any of them
+  std::vector<const PassInfo *> passes;
+  for (auto &stage : opt_stages) {
+    auto info = registry.getPassInfo(stage);
+    if (!info || !info->getNormalCtor()) {
+      errs() << argv[0] << ": unknown pass: " << stage << "\n";
+      return 1;
+    }
+    passes.push_back(info);
+  }
+
+  for (auto info : passes) {
+    start = Clock::now();
+    auto M = module.get();
+    std::unique_ptr<Module> copy;
+    if (!opt_shareModule) {
+      copy = CloneModule(*module);
+      M = copy.get();
+    }
+
+    legacy::PassManager PM;
+    PM.add(info->createPass());
+    PM.run(*M);
+    timings.push_back({info->getPassArgument().str(), getElapsedMs(start)});
+  }
+
+  errs() << "===--- dass-driver stage timings ---===\n";
+  double total = 0;
+  for (auto &t : timings) {
+    errs() << format("%12.2f ms  ", t.second) << t.first << "\n";
+    total += t.second;
+  }
+  errs() << format("%12.2f ms  ", total) << "total\n";
+  return 0;
+}
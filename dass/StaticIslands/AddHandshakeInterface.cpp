@@ -8,6 +8,7 @@
 //--------------------------------------------------------//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -80,6 +81,60 @@ static void printHLSTCl(llvm::raw_fd_ostream &out, std::string projName,
     out << "export_design -flow syn -rtl vhdl -format ip_catalog\n";
 }
 
+static void addReferences(const Value *value,
+                          SmallPtrSetImpl<const GlobalValue *> &refs,
+                          SmallPtrSetImpl<const Constant *> &visited,
+                          std::vector<const GlobalValue *> &worklist) {
+  if (auto gv = dyn_cast<GlobalValue>(value)) {
+    if (refs.insert(gv).second)
+      worklist.push_back(gv);
+  } else if (auto c = dyn_cast<Constant>(value)) {
+    if (visited.insert(c).second)
+      for (auto &op : c->operands())
+        addReferences(op, refs, visited, worklist);
+  }
+}
+
+// Copy of the module that only keeps the function, the functions it calls
+// and the globals they reference, instead of the whole program
+static std::unique_ptr<Module> extractFunction(Module &M, Function *F) {
+  SmallPtrSet<const GlobalValue *, 32> refs;
+  SmallPtrSet<const Constant *, 32> visited;
+  std::vector<const GlobalValue *> worklist;
+  addReferences(F, refs, visited, worklist);
+  while (!worklist.empty()) {
+    auto gv = worklist.back();
+    worklist.pop_back();
+    if (auto func = dyn_cast<Function>(gv)) {
+      for (auto &BB : *func)
+        for (auto &I : BB)
+          for (auto &op : I.operands())
+            addReferences(op, refs, visited, worklist);
+    } else if (auto var = dyn_cast<GlobalVariable>(gv)) {
+      if (var->hasInitializer())
+        addReferences(var->getInitializer(), refs, visited, worklist);
+    } else if (auto alias = dyn_cast<GlobalAlias>(gv))
+      addReferences(alias->getAliasee(), refs, visited, worklist);
+  }
+
+  ValueToValueMapTy VMap;
+  auto newModule = CloneModule(
+      M, VMap, [&](const GlobalValue *gv) { return refs.count(gv) > 0; });
+
+  // The definitions out of the closure are left as declarations, drop them
+  for (auto it = newModule->begin(); it != newModule->end();) {
+    auto &func = *it++;
+    if (func.isDeclaration() && func.use_empty())
+      func.eraseFromParent();
+  }
+  for (auto it = newModule->global_begin(); it != newModule->global_end();) {
+    auto &var = *it++;
+    if (var.isDeclaration() && var.use_empty())
+      var.eraseFromParent();
+  }
+  return newModule;
+}
+
 bool DirectSynthesisPass::runOnModule(Module &M) {
   assert(opt_irDir != "" && "Please specify the input LLVM IR file");
   std::error_code ec;
@@ -100,7 +155,7 @@ bool DirectSynthesisPass::runOnModule(Module &M) {
 
     // If no loop in the function, do function pipelining
     if (LI.empty()) {
-      auto newModule = CloneModule(M);
+      auto newModule = extractFunction(M, &F);
       auto ssfunc = newModule->getFunction(fname);
       ssfunc->addFnAttr("fpga.top.func", fname);
       ssfunc->addFnAttr("fpga.demangled.func", fname);
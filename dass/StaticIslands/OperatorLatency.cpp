@@ -0,0 +1,73 @@
+#include "StaticIslands.h"
+
+using namespace llvm;
+
+// Latency in cycles of the operators in the dataflow circuit, characterised
+// from the IP cores in components/ip_<target> and the elastic components. The
+// bitwidth is the width of the operands, where 0 matches any width.
+struct operatorLatency {
+  unsigned opcode;
+  unsigned bitwidth;
+  unsigned latency;
+};
+
+// Integer units and memory accesses are not device specific IPs
+static const std::vector<operatorLatency> commonLatencies = {
+    {Instruction::Mul, 0, 4},   {Instruction::SDiv, 0, 36},
+    {Instruction::UDiv, 0, 36}, {Instruction::SRem, 0, 36},
+    {Instruction::URem, 0, 36}, {Instruction::FCmp, 0, 1},
+    {Instruction::Load, 0, 2},  {Instruction::Store, 0, 1},
+};
+
+// xc7z020clg484-1
+static const std::vector<operatorLatency> zynqLatencies = {
+    {Instruction::FAdd, 32, 5},  {Instruction::FSub, 32, 5},
+    {Instruction::FMul, 32, 4},  {Instruction::FDiv, 32, 16},
+    {Instruction::FAdd, 64, 7},  {Instruction::FSub, 64, 7},
+    {Instruction::FMul, 64, 7},  {Instruction::FDiv, 64, 59},
+};
+
+// xcvu125-flva2104-1-i
+static const std::vector<operatorLatency> xcvuLatencies = {
+    {Instruction::FAdd, 32, 5},  {Instruction::FSub, 32, 5},
+    {Instruction::FMul, 32, 4},  {Instruction::FDiv, 32, 10},
+    {Instruction::FAdd, 64, 5},  {Instruction::FSub, 64, 5},
+    {Instruction::FMul, 64, 6},  {Instruction::FDiv, 64, 31},
+};
+
+// Latencies of the device selected by -target, given as a part or a device
+// family name
+static const std::vector<operatorLatency> &getTargetLatencies() {
+  std::string target = opt_target;
+  if (target.compare(0, 4, "xcvu") == 0)
+    return xcvuLatencies;
+  if (target.compare(0, 4, "xc7z") == 0 || target == "zynq")
+    return zynqLatencies;
+  // The target is given by the user, so this is not an internal error
+  report_fatal_error(Twine("Unsupported target for latency estimation: ") +
+                         target,
+                     false);
+}
+
+static bool findLatency(const std::vector<operatorLatency> &table,
+                        unsigned opcode, unsigned bitwidth,
+                        unsigned &latency) {
+  for (auto &op : table)
+    if (op.opcode == opcode && (op.bitwidth == 0 || op.bitwidth == bitwidth)) {
+      latency = op.latency;
+      return true;
+    }
+  return false;
+}
+
+unsigned getOperatorLatency(Instruction *inst) {
+  auto type = (inst->getNumOperands() > 0) ? inst->getOperand(0)->getType()
+                                           : inst->getType();
+  auto bitwidth = type->getScalarSizeInBits();
+
+  static auto &targetLatencies = getTargetLatencies();
+  unsigned latency = 0;
+  if (!findLatency(targetLatencies, inst->getOpcode(), bitwidth, latency))
+    findLatency(commonLatencies, inst->getOpcode(), bitwidth, latency);
+  return latency;
+}
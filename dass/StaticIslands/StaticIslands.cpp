@@ -16,7 +16,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/DependenceAnalysis.h"
 #include "llvm/Analysis/LoopAccessAnalysis.h"
@@ -87,29 +91,60 @@ static bool canMerge(ENode *fromNode, ENode *toNode) {
   return true;
 }
 
-static void merge(ENode *fromNode, ENode *toNode, ENode_vec *enode_dag,
-                  ENode_int_map &staticMap) {
-  auto fromIsland = staticMap[fromNode];
-  auto toIsland = staticMap[toNode];
-  for (auto &enode : *enode_dag)
-    if (staticMap[enode] == fromIsland)
-      staticMap[enode] = toIsland;
+// Disjoint sets of the ENode indices in the DAG, with path compression and
+// union by rank, so merging the islands is near linear in the number of edges
+struct IslandSets {
+  std::vector<int> parent;
+  std::vector<unsigned> rank;
+
+  IslandSets(unsigned size) : parent(size), rank(size, 0) {
+    for (unsigned i = 0; i < size; i++)
+      parent[i] = i;
+  }
+
+  int find(int i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+
+  void unite(int i, int j) {
+    i = find(i);
+    j = find(j);
+    if (i == j)
+      return;
+    if (rank[i] < rank[j])
+      std::swap(i, j);
+    parent[j] = i;
+    if (rank[i] == rank[j])
+      rank[i]++;
+  }
+};
+
+static void merge(ENode *fromNode, ENode *toNode, IslandSets &islands,
+                  ENode_int_map &nodeIdx) {
+  islands.unite(nodeIdx[fromNode], nodeIdx[toNode]);
 }
 
+// Label each ENode with the ID of its island in staticMap
 static void addStaticIslands(ENode_vec *enode_dag, ENode_int_map &staticMap) {
   // Init
+  ENode_int_map nodeIdx;
   auto islandCount = 0;
   for (auto enode : *enode_dag)
-    staticMap[enode] = islandCount++;
+    nodeIdx[enode] = islandCount++;
+  IslandSets islands(islandCount);
 
   // Merge neighbors as an island
   for (auto enode : *enode_dag) {
     for (auto pred : *enode->CntrlPreds)
-      if (canMerge(pred, enode))
-        merge(pred, enode, enode_dag, staticMap);
+      if (nodeIdx.count(pred) && canMerge(pred, enode))
+        merge(pred, enode, islands, nodeIdx);
     for (auto succs : *enode->CntrlSuccs)
-      if (canMerge(enode, succs))
-        merge(enode, succs, enode_dag, staticMap);
+      if (nodeIdx.count(succs) && canMerge(enode, succs))
+        merge(enode, succs, islands, nodeIdx);
   }
 
   // Merge fork with successors iff all of them can be merged and are in the
@@ -121,15 +156,22 @@ static void addStaticIslands(ENode_vec *enode_dag, ENode_int_map &staticMap) {
       bool toMerge = true;
       int island = -1;
       for (auto succs : *enode->CntrlSuccs) {
+        if (!nodeIdx.count(succs)) {
+          toMerge = false;
+          break;
+        }
         if (island == -1)
-          island = staticMap[succs];
-        toMerge &= (canMerge(succs) && island == staticMap[succs]);
+          island = islands.find(nodeIdx[succs]);
+        toMerge &= (canMerge(succs) && island == islands.find(nodeIdx[succs]));
       }
       if (toMerge)
         for (auto succs : *enode->CntrlSuccs)
-          merge(succs, enode, enode_dag, staticMap);
+          merge(succs, enode, islands, nodeIdx);
     }
   }
+
+  for (auto enode : *enode_dag)
+    staticMap[enode] = islands.find(nodeIdx[enode]);
 }
 
 //--------------------------------------------------------//
@@ -149,23 +191,32 @@ struct islandNode {
   // unsigned floatDiv = 0;
 };
 
-static islandNode *getIslands(int islandID, ENode_vec *enode_dag,
-                              ENode_int_map &staticMap) {
-  islandNode *island = new islandNode;
-  for (auto &enode : *enode_dag)
-    if (staticMap[enode] == islandID) {
-      island->nodes.push_back(enode);
-      if (enode->type == Inst_) {
-        auto inst = enode->Instr;
-        if (isa<llvm::BinaryOperator>(inst) || isa<llvm::CmpInst>(inst))
-          island->instSize++;
-      }
+// Bucket the ENodes by island in one pass over the DAG. Islands too small to
+// be worth a static function are dropped.
+static std::map<int, islandNode *> getIslands(ENode_vec *enode_dag,
+                                              ENode_int_map &staticMap) {
+  std::map<int, islandNode *> islands;
+  for (auto &enode : *enode_dag) {
+    auto &island = islands[staticMap[enode]];
+    if (!island)
+      island = new islandNode;
+    island->nodes.push_back(enode);
+    if (enode->type == Inst_) {
+      auto inst = enode->Instr;
+      if (isa<llvm::BinaryOperator>(inst) || isa<llvm::CmpInst>(inst))
+        island->instSize++;
     }
-  if (island->nodes.size() <= 1 || island->instSize <= 1) {
-    delete island;
-    return nullptr;
-  } else
-    return island;
+  }
+
+  for (auto it = islands.begin(); it != islands.end();) {
+    auto island = it->second;
+    if (island->nodes.size() <= 1 || island->instSize <= 1) {
+      delete island;
+      it = islands.erase(it);
+    } else
+      it++;
+  }
+  return islands;
 }
 
 static void appendArgs(Instruction *inst, std::vector<Value *> &inputs) {
@@ -530,9 +581,10 @@ bool StaticInstrPass::runOnModule(Module &M) {
     addStaticIslands(cdfg.enode_dag, staticMap);
 
     // Rewrite function
-    for (int i = 0; i < cdfg.enode_dag->size(); i++)
-      if (auto island = getIslands(i, cdfg.enode_dag, staticMap))
-        functionalise(island->nodes, i, staticMap, F);
+    for (auto &island : getIslands(cdfg.enode_dag, staticMap)) {
+      functionalise(island.second->nodes, island.first, staticMap, F);
+      delete island.second;
+    }
   }
   return true;
 }
@@ -592,156 +644,154 @@ static Instruction *getLoopEnrtyBranch(Loop *loop) {
   return dyn_cast<Instruction>(branchInst);
 }
 
-// TODO: temporary latency of the ENode, need to be sync with the latest dhls
 static int getNodeLatency(ENode *node) {
-  if (node->type != Inst_)
+  if (node->type != Inst_ || !node->Instr)
     return 0;
+  return getOperatorLatency(node->Instr);
+}
 
-  auto inst = node->Instr;
-  if (!inst)
-    return 0;
+typedef llvm::SmallPtrSet<BasicBlock *, 16> BB_set;
 
-  switch (inst->getOpcode()) {
-  case Instruction::Mul:
-    return 4;
-  case Instruction::SRem:
-    return 16;
-  case Instruction::URem:
-    return 16;
-  case Instruction::SDiv:
-    return 32;
-  case Instruction::FMul:
-    return 5;
-  case Instruction::FAdd:
-    return 4;
-  case Instruction::FSub:
-    return 4;
-  case Instruction::FDiv:
-    return 16;
-  case Instruction::FCmp:
-    return 1;
-  case Instruction::Store:
-    return 1;
-  case Instruction::Load:
-    return 2;
-  default:
-    return 0;
-  }
+static bool isCycleEdge(ENode *succ, ENode *dst, BB_set &blocks) {
+  // Skip the cycle that goes outside the loop
+  if (!succ->BB || !blocks.count(succ->BB))
+    return false;
+
+  // Skip the cycle that connects a branch for another induction
+  // variable
+  if ((succ->type == Branch_n || succ->type == Branch_c ||
+       succ->type == Branch_) &&
+      succ->BB == dst->BB && succ != dst)
+    return false;
+  return true;
 }
 
-struct CycleInfo {
-  unsigned latency = 0;
-  double probability = 1.0;
-  bool valid = false;
-  std::vector<BasicBlock *> bbpath;
-};
+// Post order of the nodes on the cycles from node to dst. The loop body is
+// acyclic once the back edge at dst is cut, so the reverse is a topological
+// order.
+static void sortCycleNodes(ENode *node, ENode *dst, BB_set &blocks,
+                           llvm::DenseSet<ENode *> &visited,
+                           std::vector<ENode *> &postOrder) {
+  visited.insert(node);
+  if (node != dst)
+    for (auto succ : *node->CntrlSuccs)
+      if (isCycleEdge(succ, dst, blocks) && !visited.count(succ))
+        sortCycleNodes(succ, dst, blocks, visited, postOrder);
+  postOrder.push_back(node);
+}
 
-static void
-exploreCycles(int cycleID, llvm::DenseMap<int, CycleInfo *> &cycleMap,
-              ENode *node, ENode *dst, ArrayRef<BasicBlock *> blocks,
-              std::vector<BBNode *> *bbnode_dag, double totdalFreq) {
-  assert(cycleMap.count(cycleID));
-  // End of cycle
-  if (node == dst) {
-    cycleMap[cycleID]->valid = true;
-    return;
+// Scratch storage of the cycle analysis. One workspace is shared by all the
+// cycles checked in a pass and is cleared without releasing its memory, so
+// the pass allocates for the largest loop once instead of for every cycle.
+struct CycleWorkspace {
+  llvm::DenseSet<ENode *> visited;
+  std::vector<ENode *> postOrder;
+  llvm::DenseSet<ENode *> toDst;
+  llvm::DenseMap<ENode *, unsigned> worstLatency;
+  // Block paths to dst, stored as a trie of (block entered, rest of the
+  // path) with the empty path at index 0
+  std::vector<std::pair<BasicBlock *, unsigned>> bbpaths;
+  llvm::DenseMap<std::pair<BasicBlock *, unsigned>, unsigned> bbpathIdx;
+  // Longest latency from each node to dst for each block path
+  llvm::DenseMap<ENode *, llvm::DenseMap<unsigned, unsigned>> pathLatency;
+
+  void clear() {
+    visited.clear();
+    postOrder.clear();
+    toDst.clear();
+    worstLatency.clear();
+    bbpaths.clear();
+    bbpathIdx.clear();
+    pathLatency.clear();
   }
 
-  int i = 0;
-  for (auto succ : *node->CntrlSuccs) {
-    // Skip the cycle that goes outside the loop
-    if (!succ->BB ||
-        std::find(blocks.begin(), blocks.end(), succ->BB) == blocks.end())
-      continue;
+  unsigned getBBPath(BasicBlock *bb, unsigned rest) {
+    auto inserted =
+        bbpathIdx.insert({std::make_pair(bb, rest), bbpaths.size()});
+    if (inserted.second)
+      bbpaths.push_back({bb, rest});
+    return inserted.first->second;
+  }
+};
 
-    // Skip the cycle that connects a branch for another induction
-    // variable
-    if ((succ->type == Branch_n || succ->type == Branch_c ||
-         succ->type == Branch_) &&
-        succ->BB == dst->BB && succ != dst)
+// The latency of a cycle is the sum of the node latencies from src to dst.
+// Cycles taking the same block path share the probability of the path,
+// which is the least frequent block edge on it, and count with the longest
+// latency among them. The expected latency weights each block path with its
+// probability and the worst case is the longest path from src to dst. Both
+// are computed in one pass over the nodes in reverse topological order,
+// which keeps one latency per node and block path instead of enumerating the
+// cycles, which grow exponentially with the number of conditionals.
+static double getCycleLoss(ENode *src, ENode *dst, BB_set &blocks,
+                           std::vector<BBNode *> *bbnode_dag,
+                           CycleWorkspace &ws) {
+  ws.clear();
+  auto &postOrder = ws.postOrder;
+  sortCycleNodes(src, dst, blocks, ws.visited, postOrder);
+
+  // Only the paths reaching dst are cycles
+  auto &toDst = ws.toDst;
+  auto &worstLatency = ws.worstLatency;
+  auto &pathLatency = ws.pathLatency;
+  ws.bbpaths.push_back({nullptr, 0});
+  for (auto node : postOrder) {
+    if (node == dst) {
+      toDst.insert(node);
+      worstLatency[node] = 0;
+      pathLatency[node][0] = 0;
       continue;
-
-    int id;
-    // Duplicate cycle info for new cycles
-    if (i != node->CntrlSuccs->size() - 1) {
-      id = cycleMap.size();
-      assert(!cycleMap.count(id));
-      cycleMap[id] = new CycleInfo;
-      cycleMap[id]->latency = cycleMap[cycleID]->latency;
-      cycleMap[id]->probability = cycleMap[cycleID]->probability;
-      cycleMap[id]->bbpath = cycleMap[cycleID]->bbpath;
-    } else
-      id = cycleID;
-
-    cycleMap[id]->latency += getNodeLatency(succ);
-
-    // Block transition
-    if (succ->BB != node->BB) {
-      cycleMap[id]->bbpath.push_back(succ->BB);
-
-      assert(getBBNode(node->BB, bbnode_dag)
-                 ->succ_freqs.count(succ->BB->getName()));
-      double newP =
-          getBBNode(node->BB, bbnode_dag)->get_succ_freq(succ->BB->getName()) /
-          totdalFreq;
-
-      assert(newP > 0 && newP <= 1);
-      cycleMap[id]->probability = std::min(cycleMap[id]->probability, newP);
     }
-
-    exploreCycles(id, cycleMap, succ, dst, blocks, bbnode_dag, totdalFreq);
-    i++;
-  }
-}
-
-static void extractCycleInfo(CycleInfo *cycleInfo,
-                             std::vector<CycleInfo *> &finalCycles) {
-  int i = 0;
-  // Search for existing cycle with the same bb path
-  int exist = -1;
-  for (auto finalCycle : finalCycles) {
-    if (finalCycle->bbpath == cycleInfo->bbpath) {
-      finalCycles[i]->latency =
-          std::max(finalCycles[i]->latency, cycleInfo->latency);
-      assert(finalCycles[i]->probability == cycleInfo->probability);
-      return;
+    for (auto succ : *node->CntrlSuccs) {
+      if (!toDst.count(succ) || !isCycleEdge(succ, dst, blocks))
+        continue;
+      toDst.insert(node);
+      unsigned nodeLatency = getNodeLatency(succ);
+      auto &worst = worstLatency[node];
+      worst = std::max(worst, nodeLatency + worstLatency[succ]);
+      // succ is already in pathLatency, so inserting node first keeps both
+      // references valid
+      auto &paths = pathLatency[node];
+      for (auto &path : pathLatency.find(succ)->second) {
+        // Block transition
+        auto bbpath = (succ->BB != node->BB)
+                          ? ws.getBBPath(succ->BB, path.first)
+                          : path.first;
+        auto &latency = paths[bbpath];
+        latency = std::max(latency, nodeLatency + path.second);
+      }
     }
-    i++;
   }
-  finalCycles.push_back(cycleInfo);
-}
+  if (!toDst.count(src))
+    return 0;
 
-static double getCycleLoss(ENode *src, ENode *dst,
-                           ArrayRef<BasicBlock *> blocks,
-                           std::vector<BBNode *> *bbnode_dag) {
-  llvm::DenseMap<int, CycleInfo *> cycleMap;
-  cycleMap[0] = new CycleInfo;
   double totdalFreq = 0;
   for (auto &freq : getBBNode(src->BB, bbnode_dag)->succ_freqs)
     totdalFreq += freq.second;
 
-  exploreCycles(0, cycleMap, src, dst, blocks, bbnode_dag, totdalFreq);
-
-  std::vector<CycleInfo *> finalCycles;
-  for (auto &cycleInfo : cycleMap)
-    if (cycleInfo.second->valid)
-      extractCycleInfo(cycleInfo.second, finalCycles);
-
   double dynamicThroughput = 0, probVerify = 0;
-  unsigned int staticThroughput = 0;
-  for (auto cycleInfo : finalCycles) {
-    llvm::errs() << cycleInfo->probability << " : " << cycleInfo->latency
-                 << ", " << finalCycles.size() << "\n";
-    dynamicThroughput += cycleInfo->latency * cycleInfo->probability;
-    probVerify += cycleInfo->probability;
-    staticThroughput = std::max(cycleInfo->latency, staticThroughput);
+  for (auto &path : pathLatency[src]) {
+    double probability = 1.0;
+    auto bb = src->BB;
+    for (auto i = path.first; i != 0; i = ws.bbpaths[i].second) {
+      auto next = ws.bbpaths[i].first;
+      assert(getBBNode(bb, bbnode_dag)->succ_freqs.count(next->getName()));
+      double newP = getBBNode(bb, bbnode_dag)->get_succ_freq(next->getName()) /
+                    totdalFreq;
+      assert(newP > 0 && newP <= 1);
+      probability = std::min(probability, newP);
+      bb = next;
+    }
+    dynamicThroughput += path.second * probability;
+    probVerify += probability;
   }
-  if (probVerify != 1.0) {
+  if (std::abs(probVerify - 1.0) > 1e-9) {
     llvm_unreachable(
         std::string("Loop probability is not 1: " + std::to_string(probVerify))
             .c_str());
   }
 
+  unsigned int staticThroughput = worstLatency[src];
+
   double cycleLoss =
       ((double)staticThroughput - dynamicThroughput) / (dynamicThroughput + 1);
 
@@ -753,10 +803,11 @@ static double getCycleLoss(ENode *src, ENode *dst,
 }
 
 static double getThroughputLoss(Loop *loop, std::vector<ENode *> *enode_dag,
-                                std::vector<BBNode *> *bbnode_dag) {
+                                std::vector<BBNode *> *bbnode_dag,
+                                CycleWorkspace &ws) {
   auto header = loop->getHeader();
   auto latch = loop->getLoopLatch();
-  auto blocks = loop->getBlocks();
+  BB_set blocks(loop->block_begin(), loop->block_end());
   double loss = 0;
 
   // For each cycle
@@ -764,7 +815,7 @@ static double getThroughputLoss(Loop *loop, std::vector<ENode *> *enode_dag,
     if (node->type == Phi_ && node->BB == header) {
       for (auto pred : *node->CntrlPreds) {
         if (pred->type == Branch_n && pred->BB == latch) {
-          auto cycleLoss = getCycleLoss(node, pred, blocks, bbnode_dag);
+          auto cycleLoss = getCycleLoss(node, pred, blocks, bbnode_dag, ws);
           loss = std::max(loss, cycleLoss);
         }
       }
@@ -839,6 +890,7 @@ bool StaticControlLoopPass::runOnModule(Module &M) {
       fList.push_back(&F);
   }
 
+  CycleWorkspace ws;
   for (auto F : fList) {
     // Get dot graph
     auto &cdfg = getAnalysis<MyCFGPass>(*F);
@@ -860,7 +912,8 @@ bool StaticControlLoopPass::runOnModule(Module &M) {
 
       auto branch = getLoopEnrtyBranch(loop);
       if (branch->getMetadata("dass_cdfg_check")) {
-        auto loss = getThroughputLoss(loop, cdfg.enode_dag, cdfg.bbnode_dag);
+        auto loss =
+            getThroughputLoss(loop, cdfg.enode_dag, cdfg.bbnode_dag, ws);
         if (loss <= opt_Loss) {
           llvm::errs() << "Final Loss = " << loss << ": ";
           loop->dump();
@@ -160,6 +160,7 @@ AutopilotParser::AutopilotParser(std::ifstream &ifile, Function *F) {
     pipelineStates[stateID] = ps;
     stateID++;
   }
+  indexSchedule();
 }
 
 // Load info from module itself
@@ -202,65 +203,91 @@ static std::string getOp(std::string line) {
          " ";
 }
 
-// Get the objective where the argument is used.
-static std::string getUse(const std::string &name,
-                          llvm::DenseMap<int, pipelineState *> &pipelineStates,
-                          const int states, bool isRead) {
+// Parse the ops of all the states once. An op names a value v when it
+// contains " %v " or " %v,", and assigns it when it contains " %v = ".
+void AutopilotParser::indexSchedule() {
+  ops.clear();
+  stateOps.assign(1, 0);
+  refs.clear();
   for (int st = 1; st <= states; st++) {
-    for (auto stmt : pipelineStates[st]->stmts) {
+    stateOps.push_back(ops.size());
+    for (auto &stmt : pipelineStates[st]->stmts) {
       auto op = getOp(stmt);
-      if (op.find(" %" + name + " ") != std::string::npos ||
-          op.find(" %" + name + ",") != std::string::npos) {
-        if (isRead && (op.find(" read ") != std::string::npos ||
-                       op.find(" nbread ") != std::string::npos)) {
-          auto start = op.find("%") + 1;
-          return op.substr(start, op.find(" =") - start);
-        } else if (!isRead && (op.find(" write ") != std::string::npos ||
-                               op.find(" nbwrite ") != std::string::npos)) {
-          auto start = op.rfind("%") + 1;
-          return op.substr(start, op.rfind(" ") - start);
-        }
+      scheduleOp sOp;
+      sOp.state = st;
+      auto assign = op.find(" =");
+      if (assign != std::string::npos && op.find("%") < assign)
+        sOp.def = op.substr(op.find("%") + 1, assign - op.find("%") - 1);
+      auto last = op.rfind("%");
+      if (last != std::string::npos)
+        sOp.lastVar = op.substr(last + 1, op.rfind(" ") - last - 1);
+
+      std::vector<std::string> tokens;
+      size_t pos = 1, end;
+      while ((end = op.find(" ", pos)) != std::string::npos) {
+        tokens.push_back(op.substr(pos, end - pos));
+        pos = end + 1;
+      }
+
+      auto opIdx = (int)ops.size();
+      for (auto i = 0; i < tokens.size(); i++) {
+        auto &token = tokens[i];
+        if (token == "read" || token == "nbread")
+          sOp.isRead = true;
+        else if (token == "write" || token == "nbwrite")
+          sOp.isWrite = true;
+        if (token.size() < 2 || token[0] != '%')
+          continue;
+        auto name = token.substr(1, token.find(",") - 1);
+        if (name.empty())
+          continue;
+        auto isDef = (name.size() + 1 == token.size() &&
+                      i + 1 < tokens.size() && tokens[i + 1] == "=");
+        auto &nameRefs = refs[name];
+        if (!nameRefs.empty() && nameRefs.back().op == opIdx)
+          nameRefs.back().isDef |= isDef;
+        else
+          nameRefs.push_back({opIdx, isDef});
       }
+      ops.push_back(sOp);
     }
   }
-  llvm::errs() << "Cannot find schedule of argument " << name
-               << " - consider offset = 0\n";
-  return "";
+  stateOps.push_back(ops.size());
 }
 
-static int
-getOffsetFromOneState(int st, const std::string &name,
-                      llvm::DenseMap<int, pipelineState *> &pipelineStates,
-                      const bool isRead) {
-  for (auto stmt : pipelineStates[st]->stmts) {
-    auto op = getOp(stmt);
-    if (op.find(" %" + name + " ") != std::string::npos ||
-        op.find(" %" + name + ",") != std::string::npos) {
-      if (isRead && op.find(" %" + name + " = ") == std::string::npos)
-        return pipelineStates[st]->SV;
-      else if (!isRead && op.find(" %" + name + " = ") != std::string::npos)
-        return pipelineStates[st]->SV;
-    }
+const std::vector<scheduleRef> &
+AutopilotParser::getRefs(const std::string &name) {
+  static const std::vector<scheduleRef> none;
+  auto it = refs.find(name);
+  return (it == refs.end()) ? none : it->second;
+}
+
+// Get the objective where the argument is used.
+std::string AutopilotParser::getUse(const std::string &name, bool isRead) {
+  for (auto &ref : getRefs(name)) {
+    auto &op = ops[ref.op];
+    if (isRead && op.isRead)
+      return op.def;
+    else if (!isRead && op.isWrite)
+      return op.lastVar;
   }
-  return -1;
+  llvm::errs() << "Cannot find schedule of argument " << name
+               << " - consider offset = 0\n";
+  return "";
 }
 
 // Get the earliest steady state where the objective is used as the offset.
-static int getOffset(const std::string &name,
-                     llvm::DenseMap<int, pipelineState *> &pipelineStates,
-                     const int states, const bool isRead) {
-  if (isRead)
-    for (int st = 1; st <= states; st++) {
-      auto offset = getOffsetFromOneState(st, name, pipelineStates, isRead);
-      if (offset != -1)
-        return offset;
-    }
-  else
-    for (int st = states; st >= 1; st--) {
-      auto offset = getOffsetFromOneState(st, name, pipelineStates, isRead);
-      if (offset != -1)
-        return offset;
-    }
+int AutopilotParser::getOffset(const std::string &name, bool isRead) {
+  auto &nameRefs = getRefs(name);
+  if (isRead) {
+    for (auto ref = nameRefs.begin(); ref != nameRefs.end(); ref++)
+      if (!ref->isDef)
+        return pipelineStates[ops[ref->op].state]->SV;
+  } else {
+    for (auto ref = nameRefs.rbegin(); ref != nameRefs.rend(); ref++)
+      if (ref->isDef)
+        return pipelineStates[ops[ref->op].state]->SV;
+  }
   return -1;
 }
 
@@ -276,10 +303,8 @@ void AutopilotParser::anlayzePortInfo(bool hasOffset) {
       continue;
 
     bool isRead = (portInfo[i]->getType() == INPUT);
-    auto useName =
-        getUse(portInfo[i]->getName(), pipelineStates, states, isRead);
-    auto offset = (useName == "") ? 0 : getOffset(useName, pipelineStates,
-                                                  states, isRead);
+    auto useName = getUse(portInfo[i]->getName(), isRead);
+    auto offset = (useName == "") ? 0 : getOffset(useName, isRead);
     if (offset == -1)
       llvm_unreachable(std::string(func->getName().str() +
                                    ": Cannot find schedule of use " + useName)
@@ -292,39 +317,50 @@ void AutopilotParser::anlayzePortInfo(bool hasOffset) {
   }
 }
 
+// Follow the chain of ops starting from the use of name after offset: the
+// first op latency counts the busy states until the second op of the chain,
+// and the idle states are those where the current value of the chain is not
+// named. Only the states naming the value are visited.
 void AutopilotParser::getIdleStatesAndFirstOpLatency(const std::string &name,
                                                      const int offset,
                                                      int *firstOpLatency,
                                                      int *idleStates) {
   auto isFirstOp = false;
-  auto varName = "%" + name;
+  auto varName = name;
   auto idleStateCount = 0, firstOpLatencyCount = 0;
-  for (int st = offset + 1; st <= states; st++) {
+  auto st = offset + 1;
+  while (st <= states) {
     auto isIdle = true;
-    auto useCount = 0;
-    for (auto stmt : pipelineStates[st]->stmts) {
-      auto op = getOp(stmt);
-      if (op.find(" " + varName + " ") != std::string::npos ||
-          op.find(" " + varName + ",") != std::string::npos) {
-        if (op.find(" " + varName + " = ") == std::string::npos) {
-          // Stop counting when there are multiple uses
-          if (useCount > 0) {
-            *firstOpLatency = firstOpLatencyCount;
-            *idleStates = idleStateCount;
-          }
-          if (isFirstOp)
-            isFirstOp = false;
-          if (varName == "%" + name)
-            isFirstOp = true;
-          varName = op.substr(op.find("%"), op.find(" =") - op.find("%"));
-          useCount++;
-        }
-        isIdle = false;
+    auto next = stateOps[st];
+    while (true) {
+      auto &varRefs = getRefs(varName);
+      auto ref = std::lower_bound(
+          varRefs.begin(), varRefs.end(), next,
+          [](const scheduleRef &r, int op) { return r.op < op; });
+      if (ref == varRefs.end() || ref->op >= stateOps[st + 1])
+        break;
+      next = ref->op + 1;
+      isIdle = false;
+      if (!ref->isDef) {
+        if (isFirstOp)
+          isFirstOp = false;
+        if (varName == name)
+          isFirstOp = true;
+        varName = ops[ref->op].def;
       }
     }
     idleStateCount += isIdle;
     if (isFirstOp && !isIdle)
       firstOpLatencyCount++;
+
+    // Skip to the next state naming the value, the ones between are idle
+    auto &varRefs = getRefs(varName);
+    auto ref = std::lower_bound(
+        varRefs.begin(), varRefs.end(), stateOps[st + 1],
+        [](const scheduleRef &r, int op) { return r.op < op; });
+    auto nextSt = (ref == varRefs.end()) ? states + 1 : ops[ref->op].state;
+    idleStateCount += nextSt - st - 1;
+    st = nextSt;
   }
   *firstOpLatency = firstOpLatencyCount;
   *idleStates = idleStateCount;
@@ -336,7 +372,7 @@ void AutopilotParser::analyzeIdleStatesAndFirstOpLatency() {
     if (portInfo[i]->getType() != INPUT || portInfo[i]->getOffset() == 0)
       continue;
 
-    auto useName = getUse(portInfo[i]->getName(), pipelineStates, states, true);
+    auto useName = getUse(portInfo[i]->getName(), true);
     int idleStates = 0, firstOpLatency = 0;
     getIdleStatesAndFirstOpLatency(useName, portInfo[i]->getOffset(),
                                    &firstOpLatency, &idleStates);
@@ -11,8 +11,9 @@
 // Pass: BufferIfStmtPass
 // This pass a fix to the buffering tool in Dynamatic that does not balance the
 // throughput of two if branches after the if statements are optimized using
-// short paths. This pass reads the buffer log and identify the throughput
-// difference of two branches and inserts buffers for balancing.
+// short paths. This pass computes the throughput of the marked graphs taking
+// each of the two branches in the buffered circuit and inserts buffers to
+// balance their difference.
 //--------------------------------------------------------//
 
 #include "llvm/IR/Constant.h"
@@ -30,11 +31,15 @@
 #include "Nodes.h"
 
 #include "AutopilotParser.h"
+#include "DotGraph.h"
+#include "MarkedGraph.h"
 #include "Synthesis.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <map>
+#include <set>
 
 using namespace llvm;
 using namespace AutopilotParser;
@@ -53,11 +58,15 @@ static int getMaxInputOffsetDepth(AutopilotParser::AutopilotParser *ap) {
   return offsetDepth;
 }
 
+// Name of the nodes holding the offset latency of a call input. They are
+// printed as "<name>_<id>" and bypassed once the graph is buffered.
+static const std::string callDummyName = "dummy";
+
 static void insertCallNodeBefore(int in, ENode *enodeIn, ENode *enode,
                                  int latency, ENode_vec *enodes) {
   // Create new type called dummy?
   auto callNode = new ENode(Inst_, enode->BB);
-  callNode->Name = "dummy";
+  callNode->Name = callDummyName;
   callNode->Instr = enode->Instr;
   callNode->isMux = false;
   callNode->isCntrlMg = false;
@@ -205,6 +214,15 @@ bool LoadOffsetCFGPass::runOnModule(Module &M) {
 // Pass declaration: RemoveCallDummyPass
 //--------------------------------------------------------//
 
+static void getDotGraph(std::string fileName, DotGraph &dotGraph) {
+  std::ifstream ifile(fileName);
+  if (!ifile.is_open())
+    llvm_unreachable(
+        std::string("Cannot find dot file " + fileName + ".\n").c_str());
+  dotGraph.read(ifile);
+  ifile.close();
+}
+
 namespace {
 class RemoveCallDummyPass : public llvm::ModulePass {
 
@@ -224,10 +242,21 @@ bool RemoveCallDummyPass::runOnModule(Module &M) {
       continue;
 
     auto fname = demangleFuncName(F.getName().str().c_str());
-    auto cmd = "python3 " + opt_DASS +
-               "/dass/scripts/DynamaticOptimizer.py -d " + fname +
-               "_graph_buf.dot";
-    system(cmd.c_str());
+    DotGraph dotGraph;
+    getDotGraph(fname + "_graph_buf.dot", dotGraph);
+
+    auto prefix = callDummyName + "_";
+    for (auto &node : dotGraph.getNodes())
+      if (node.compare(0, prefix.size(), prefix) == 0 &&
+          dotGraph.getNodeAttr(node, "type") == "Operator") {
+        llvm::errs() << "Removing: " << node << "\n";
+        dotGraph.bypassNode(node);
+      }
+
+    std::error_code ec;
+    llvm::raw_fd_ostream ofile(fname + "_graph_buf_new.dot", ec);
+    dotGraph.write(ofile);
+    ofile.close();
   }
   return true;
 }
@@ -305,172 +334,200 @@ static std::vector<IfBlock *> getInnerMostIfBlocks(Function *F,
   return ifBlocks;
 }
 
-struct MG {
-  std::vector<std::pair<int, int>> edges;
-  int iteration = -1;
-  double throughput = -1;
-};
-
-static std::vector<MG *> getMarkedGraphInfo(std::string fileName) {
-  std::vector<std::string> buffLog;
-  std::ifstream ifile(fileName);
-  if (!ifile.is_open())
-    llvm_unreachable(
-        std::string("Cannot find dot file " + fileName + ".\n").c_str());
-
-  std::string line;
-  while (std::getline(ifile, line))
-    buffLog.push_back(line);
-  ifile.close();
-
-  std::vector<MG *> mgs;
+static int getBBIndex(BasicBlock *BB, ENode_vec *enode_dag) {
+  if (!BB)
+    return -1;
+  for (auto enode : *enode_dag)
+    if (enode->BB == BB)
+      return getBBIndex(enode);
+  return -1;
+}
 
-  for (auto i = 0; i < buffLog.size(); i++) {
-    if (buffLog[i].find("Total MILP time") != std::string::npos)
-      break;
+// Frequency of the block edge from the profile, 0 if it is never taken
+static double getEdgeFreq(BasicBlock *from, BasicBlock *to,
+                          std::vector<BBNode *> *bbnode_dag) {
+  auto bbNode = getBBNode(from, bbnode_dag);
+  if (!bbNode || !bbNode->succ_freqs.count(to->getName()))
+    return 0;
+  return bbNode->get_succ_freq(to->getName());
+}
 
-    if (buffLog[i].find("Iteration") != std::string::npos) {
-      auto mg = new MG;
-      mg->iteration =
-          std::stoi(buffLog[i].substr(buffLog[i].find("Iteration") +
-                                      std::string("Iteration").length())) -
-          1;
-      i++;
-      i++;
-      i++;
-      while (buffLog[i].find("->") != std::string::npos) {
-        auto src = std::stoi(buffLog[i].substr(0, buffLog[i].find("->")));
-        auto dst = std::stoi(buffLog[i].substr(buffLog[i].find("->") + 2,
-                                               buffLog[i].find(":") -
-                                                   buffLog[i].find("->") - 2));
-        mg->edges.push_back(std::pair<int, int>(src, dst));
-        i++;
+// Block edges of the marked graph that contains the given edge: the cycle
+// closed by following the most frequent block successors from the edge back
+// to its source. Empty if the edge is never taken or is not on a cycle.
+static std::set<std::pair<int, int>>
+getMGEdges(std::pair<int, int> edge, std::map<int, BasicBlock *> &bbs,
+           std::map<BasicBlock *, int> &bbIdx,
+           std::vector<BBNode *> *bbnode_dag) {
+  std::set<std::pair<int, int>> mgEdges;
+  if (!bbs.count(edge.first) || !bbs.count(edge.second))
+    return mgEdges;
+  auto src = bbs[edge.first], dst = bbs[edge.second];
+  if (getEdgeFreq(src, dst, bbnode_dag) == 0)
+    return mgEdges;
+
+  // Blocks that reach the source over taken edges
+  std::set<BasicBlock *> reachSrc = {src};
+  std::vector<BasicBlock *> worklist = {src};
+  while (!worklist.empty()) {
+    auto BB = worklist.back();
+    worklist.pop_back();
+    for (auto pred : predecessors(BB))
+      if (!reachSrc.count(pred) && getEdgeFreq(pred, BB, bbnode_dag) > 0) {
+        reachSrc.insert(pred);
+        worklist.push_back(pred);
       }
-      if (mg->edges.size() > 0)
-        mgs.push_back(mg);
-    }
+  }
 
-    if (buffLog[i].find("Throughput achieved in sub MG") != std::string::npos) {
-      auto index = std::stoi(
-          buffLog[i].substr(buffLog[i].find("MG") + 2,
-                            buffLog[i].find(":") - buffLog[i].find("MG") - 2));
-      auto throughput = std::stof(buffLog[i].substr(
-          buffLog[i].find(":") + 1,
-          buffLog[i].rfind("***") - buffLog[i].find(":") - 1));
-      for (auto j = 0; j < mgs.size(); j++)
-        if (mgs[j]->iteration == index) {
-          mgs[j]->throughput = throughput;
-          break;
-        }
+  mgEdges.insert(edge);
+  std::set<BasicBlock *> visited = {dst};
+  for (auto BB = dst; BB != src;) {
+    BasicBlock *next = nullptr;
+    double maxFreq = 0;
+    for (auto succ : successors(BB)) {
+      auto freq = getEdgeFreq(BB, succ, bbnode_dag);
+      if (reachSrc.count(succ) && freq > maxFreq) {
+        next = succ;
+        maxFreq = freq;
+      }
     }
+    if (!next || (next != src && visited.count(next)))
+      return std::set<std::pair<int, int>>();
+    mgEdges.insert(std::pair<int, int>(bbIdx[BB], bbIdx[next]));
+    visited.insert(next);
+    BB = next;
   }
+  return mgEdges;
+}
 
-  for (auto mg : mgs) {
-    llvm::errs() << "Loop " << mg->iteration << ": (";
-    for (auto edge : mg->edges)
-      llvm::errs() << edge.first << "->" << edge.second << ", ";
-    llvm::errs() << "), throughput = " << mg->throughput << "\n";
+struct DotNode {
+  int bb;
+  std::string type;
+  double latency;
+  bool isBuffer;
+};
+
+static std::map<std::string, DotNode> getDotNodes(DotGraph &dotGraph) {
+  std::map<std::string, DotNode> nodes;
+  for (auto &name : dotGraph.getNodes()) {
+    auto bb = dotGraph.getNodeAttr(name, "bbID");
+    if (bb == "")
+      continue;
+    auto &node = nodes[name];
+    node.bb = std::stoi(bb);
+    node.type = dotGraph.getNodeAttr(name, "type");
+    auto latency = dotGraph.getNodeAttr(name, "latency");
+    node.latency = (latency == "") ? 0 : std::stod(latency);
+    node.isBuffer = (node.type == "Buffer");
+    // An opaque buffer registers its output
+    if (node.isBuffer && dotGraph.getNodeAttr(name, "transparent") != "true")
+      node.latency += 1;
   }
+  return nodes;
+}
 
-  for (auto mg : mgs)
-    assert(mg->throughput != -1);
+// Throughput of the buffered circuit restricted to the marked graph that
+// contains the block edge, i.e. the inverse of its critical cycle ratio. The
+// nodes are those of the blocks on the marked graph, connected within a
+// block or along its block edges. One token per iteration enters the merges
+// of the loop header from the loop. Returns -1 if the edge is never taken or
+// the throughput cannot be computed.
+static double getMGThroughput(std::pair<int, int> edge,
+                              std::map<int, BasicBlock *> &bbs,
+                              std::map<BasicBlock *, int> &bbIdx,
+                              std::vector<BBNode *> *bbnode_dag,
+                              DominatorTree &DT, DotGraph &dotGraph,
+                              std::map<std::string, DotNode> &nodes) {
+  auto mgEdges = getMGEdges(edge, bbs, bbIdx, bbnode_dag);
+  if (mgEdges.empty())
+    return -1;
 
-  return mgs;
-}
+  std::set<int> mgBBs;
+  for (auto &e : mgEdges) {
+    mgBBs.insert(e.first);
+    mgBBs.insert(e.second);
+  }
+  // The loop header is the block of the cycle that dominates the others
+  int header = -1;
+  for (auto bb : mgBBs)
+    if (std::all_of(mgBBs.begin(), mgBBs.end(), [&](int other) {
+          return DT.dominates(bbs[bb], bbs[other]);
+        })) {
+      header = bb;
+      break;
+    }
+  if (header == -1) {
+    llvm::errs() << "Warning: Cannot find the loop header of the marked graph "
+                 << "of " << edge.first << " -> " << edge.second << "\n";
+    return -1;
+  }
+  bool isSelfLoop = mgEdges.count(std::pair<int, int>(header, header));
 
-static std::vector<std::string> getDotGraph(std::string fileName) {
-  std::vector<std::string> dotGraph;
-  std::ifstream ifile(fileName);
-  if (!ifile.is_open())
-    llvm_unreachable(
-        std::string("Cannot find dot file " + fileName + ".\n").c_str());
+  std::map<std::string, unsigned> nodeIdx;
+  for (auto &node : nodes)
+    if (mgBBs.count(node.second.bb))
+      nodeIdx.insert({node.first, nodeIdx.size()});
 
-  std::string line;
-  while (std::getline(ifile, line))
-    dotGraph.push_back(line);
-  ifile.close();
-  return dotGraph;
-}
+  MarkedGraph mg(nodeIdx.size());
+  for (auto &e : dotGraph.getEdges()) {
+    auto src = DotGraph::getName(e.src), dst = DotGraph::getName(e.dst);
+    if (e.removed || !nodeIdx.count(src) || !nodeIdx.count(dst))
+      continue;
+    auto &srcNode = nodes[src], &dstNode = nodes[dst];
+    if (srcNode.bb != dstNode.bb &&
+        !mgEdges.count(std::pair<int, int>(srcNode.bb, dstNode.bb)))
+      continue;
+    bool isMerge = (dstNode.type == "Merge" || dstNode.type == "Mux" ||
+                    dstNode.type == "CntrlMerge");
+    bool isBackEdge = isMerge && dstNode.bb == header &&
+                      (srcNode.bb != header || isSelfLoop || srcNode.isBuffer);
+    mg.addEdge(nodeIdx[src], nodeIdx[dst], srcNode.latency, isBackEdge);
+  }
 
-static int getBBIndex(BasicBlock *BB, ENode_vec *enode_dag) {
-  if (!BB)
+  // A cycle without tokens never fires
+  auto ratio = mg.getMaxCycleRatio();
+  if (!std::isfinite(ratio)) {
+    llvm::errs() << "Warning: Unknown throughput of the marked graph of "
+                 << edge.first << " -> " << edge.second << "\n";
     return -1;
-  for (auto enode : *enode_dag)
-    if (enode->BB == BB)
-      return getBBIndex(enode);
-  return -1;
+  }
+  return (ratio <= 1) ? 1 : 1 / ratio;
 }
 
-static double getMGThroughput(std::pair<int, int> edge, ArrayRef<MG *> mgs) {
-  auto count = 0;
-  double throughput = -1;
-  for (auto mg : mgs)
-    if (std::find(mg->edges.begin(), mg->edges.end(), edge) !=
-        mg->edges.end()) {
-      throughput = mg->throughput;
-      count++;
-    }
-  if (count != 1)
-    llvm::errs() << "Warning found edge " << edge.first << "->" << edge.second
-                 << " in multiple marked graphs. Throughput = " << throughput
-                 << "\n";
-  return throughput;
+static bool insertBuffer(std::string buffer, std::string branch,
+                         DotGraph &dotGraph, int depth, std::string port) {
+  auto edge = dotGraph.getInEdge(branch, port);
+  if (!edge)
+    llvm_unreachable(std::string("Cannot find the condition edge of branch " +
+                                 branch + " in the dot graph.")
+                         .c_str());
+
+  auto src = DotGraph::getName(edge->src);
+  if (src.find("_Buffer_") != std::string::npos && dotGraph.hasNode(src)) {
+    auto slots = std::stoi(dotGraph.getNodeAttr(src, "slots"));
+    dotGraph.setSlots(src, slots + depth);
+    llvm::errs() << "Expand buffer: " << src << " -> " << branch << " ";
+    return false;
+  }
+
+  dotGraph.insertNode(edge, buffer);
+  llvm::errs() << "Inserted buffer: " << src << " -> " << buffer << " -> "
+               << branch << " ";
+  return true;
 }
 
-static bool insertBuffer(std::string buffer, std::string branch,
-                         std::vector<std::string> &dotGraph,
-                         std::string &bufferDeclare, int depth,
-                         std::string port) {
-  for (int i = 0; i < dotGraph.size(); i++)
-    if (dotGraph[i].find("-> " + branch) != std::string::npos &&
-        dotGraph[i].find("to=" + port) != std::string::npos) {
-      if (dotGraph[i].find("_Buffer_") != std::string::npos) {
-        auto srcBuffer = dotGraph[i].substr(
-            dotGraph[i].find("_"),
-            dotGraph[i].find(" ", dotGraph[i].find("_") + 1) -
-                dotGraph[i].find("_"));
-        int j = 0;
-        for (j = 0; j < i; j++)
-          if (dotGraph[j].find(srcBuffer + " [") != std::string::npos)
-            break;
-        auto slots = std::stoi(dotGraph[j].substr(
-            dotGraph[j].find("slots=") + 6,
-            dotGraph[j].find(", ", dotGraph[j].find("slots=")) -
-                dotGraph[j].find("slots=") - 6));
-        dotGraph[j].replace(dotGraph[j].find("slots=") + 6,
-                            dotGraph[j].find(", ", dotGraph[j].find("slots=")) -
-                                dotGraph[j].find("slots=") - 6,
-                            std::to_string(slots + depth));
-        dotGraph[j].replace(
-            dotGraph[j].find("[", dotGraph[j].find("slots=")) + 1,
-            dotGraph[j].find("t]", dotGraph[j].find("slots=")) -
-                dotGraph[j].find("[", dotGraph[j].find("slots=")) - 1,
-            std::to_string(slots + depth));
-        llvm::errs() << "Expand buffer: " << srcBuffer << " -> " << branch
-                     << " ";
-        return false;
-      } else {
-        auto line0 = dotGraph[i];
-        auto line1 = dotGraph[i];
-        line0.replace(line0.find(branch), branch.length(), buffer);
-        line0.replace(line0.find(port) + 2, 1, "1");
-        auto src = line1.substr(0, line1.find("->") - 1);
-        line1.replace(0, line1.find("->") - 1, buffer);
-        line1.replace(line1.find("out") + 3, 1, "1");
-        dotGraph[i] = line0 + "\n" + line1;
-        llvm::errs() << "Inserted buffer: " << src << " -> " << buffer << " -> "
-                     << branch << " ";
-        return true;
-      }
-    }
-  llvm_unreachable(std::string("Cannot find the condition edge of branch " +
-                               branch + " in the dot graph.")
-                       .c_str());
+static std::string getBufferDeclaration(std::string buffer, int condBB,
+                                        int depth) {
+  return buffer + " [type=Buffer, in=\"in1:1\", out=\"out1:1\", bbID = " +
+         std::to_string(condBB) + ", slots=" + std::to_string(depth) +
+         ", transparent=true, label=\"" + buffer + " [" +
+         std::to_string(depth) +
+         "t]\",  shape=box, style=filled, fillcolor=darkolivegreen3, "
+         "height = 0.4];";
 }
 
 static void tryInsertBuffer(ENode *enode, int nextBB, int condBB, int depth,
-                            int &bufferCount, std::string &bufferDeclare,
-                            std::vector<std::string> &dotGraph,
+                            int &bufferCount, DotGraph &dotGraph,
                             ENode_vec *enode_dag) {
   // bool containsEdge = false;
   // for (auto succ : *enode->CntrlSuccs)
@@ -485,6 +542,7 @@ static void tryInsertBuffer(ENode *enode, int nextBB, int condBB, int depth,
   auto branch = getNodeDotNameNew(enode);
   branch = branch.substr(1, branch.rfind("\"") - 1);
 
+  std::vector<std::string> ports;
   // Buffer both branches if it is a short path decision branch
   if (enode->CntrlPreds->size() == 2) {
     auto in0 = enode->CntrlPreds->at(0);
@@ -494,44 +552,40 @@ static void tryInsertBuffer(ENode *enode, int nextBB, int condBB, int depth,
     if (in1->type == Fork_ || in1->type == Fork_c)
       in1 = in1->CntrlPreds->at(0);
     assert(in0->type == Branch_ || in1->type == Branch_);
-    if (in0->type == Branch_ && in1->type == Branch_) {
-      auto newBuffer0 =
-          insertBuffer("_Buffer_x" + std::to_string(bufferCount), branch,
-                       dotGraph, bufferDeclare, depth, "in1");
-      if (newBuffer0) {
-        bufferDeclare +=
-            "_Buffer_x" + std::to_string(bufferCount) +
-            " [type=Buffer, in=\"in1:1\", out=\"out1:1\", bbID = " +
-            std::to_string(condBB) + ", slots=" + std::to_string(depth) +
-            ", transparent=true, label=\"_Buffer_x" +
-            std::to_string(bufferCount) + " [" + std::to_string(depth) +
-            "t]\",  shape=box, style=filled, "
-            "fillcolor=darkolivegreen3, "
-            "height = 0.4];\n";
-        bufferCount++;
-      }
-    }
+    if (in0->type == Branch_ && in1->type == Branch_)
+      ports.push_back("in1");
   }
-
-  auto newBuffer = insertBuffer("_Buffer_x" + std::to_string(bufferCount),
-                                branch, dotGraph, bufferDeclare, depth, "in2");
-  if (newBuffer) {
-    bufferDeclare +=
-        "_Buffer_x" + std::to_string(bufferCount) +
-        " [type=Buffer, in=\"in1:1\", out=\"out1:1\", bbID = " +
-        std::to_string(condBB) + ", slots=" + std::to_string(depth) +
-        ", transparent=true, label=\"_Buffer_x" + std::to_string(bufferCount) +
-        " [" + std::to_string(depth) + "t]\",  shape=box, style=filled, "
-                                       "fillcolor=darkolivegreen3, "
-                                       "height = 0.4];\n";
-    bufferCount++;
+  ports.push_back("in2");
+
+  for (auto &port : ports) {
+    auto buffer = "_Buffer_x" + std::to_string(bufferCount);
+    if (insertBuffer(buffer, branch, dotGraph, depth, port)) {
+      if (!dotGraph.addNode(condBB, buffer,
+                            getBufferDeclaration(buffer, condBB, depth)))
+        llvm_unreachable(std::string("Cannot find block " +
+                                     std::to_string(condBB) +
+                                     " in the dot graph.")
+                             .c_str());
+      bufferCount++;
+    }
   }
   llvm::errs() << ", depth = " << depth << "\n";
 }
 
-static void bufferIfStmt(ArrayRef<IfBlock *> ifBlocks, ArrayRef<MG *> mgs,
-                         std::vector<std::string> &dotGraph,
+static void bufferIfStmt(ArrayRef<IfBlock *> ifBlocks, Function *F,
+                         std::vector<BBNode *> *bbnode_dag, DotGraph &dotGraph,
                          ENode_vec *enode_dag) {
+  std::map<int, BasicBlock *> bbs;
+  std::map<BasicBlock *, int> bbIdx;
+  for (auto &BB : *F) {
+    bbIdx[&BB] = getBBIndex(&BB, enode_dag);
+    bbs[bbIdx[&BB]] = &BB;
+  }
+  DominatorTree DT(*F);
+  auto nodes = getDotNodes(dotGraph);
+  // Buffers are numbered across the if statements, so their names are unique
+  auto bufferCount = 0;
+
   for (auto ifBlock : ifBlocks) {
     auto condBB = getBBIndex(ifBlock->condBB, enode_dag);
     auto trueBB = getBBIndex(ifBlock->trueBB, enode_dag);
@@ -543,8 +597,13 @@ static void bufferIfStmt(ArrayRef<IfBlock *> ifBlocks, ArrayRef<MG *> mgs,
     auto edge1 = (falseBB == -1) ? std::pair<int, int>(condBB, exitBB)
                                  : std::pair<int, int>(condBB, falseBB);
     assert(edge0 != edge1);
-    double t0 = getMGThroughput(edge0, mgs);
-    double t1 = getMGThroughput(edge1, mgs);
+    double t0 = getMGThroughput(edge0, bbs, bbIdx, bbnode_dag, DT, dotGraph,
+                                nodes);
+    double t1 = getMGThroughput(edge1, bbs, bbIdx, bbnode_dag, DT, dotGraph,
+                                nodes);
+    llvm::errs() << "Throughput of " << edge0.first << " -> " << edge0.second
+                 << " : " << t0 << ", " << edge1.first << " -> "
+                 << edge1.second << " : " << t1 << "\n";
 
     // One of the branches has a probability of 0
     // or two branches have the same throughput
@@ -558,8 +617,6 @@ static void bufferIfStmt(ArrayRef<IfBlock *> ifBlocks, ArrayRef<MG *> mgs,
 
     llvm::errs() << "Buffering edge : " << condBB << " -> " << nextBB << "\n";
 
-    std::string bufferDeclare = "";
-
     ENode *longPathConditionNode;
     for (auto enode : *enode_dag)
       if (enode->BB == ifBlock->condBB && enode->type == Branch_ &&
@@ -573,23 +630,15 @@ static void bufferIfStmt(ArrayRef<IfBlock *> ifBlocks, ArrayRef<MG *> mgs,
             ? longPathConditionNode->CntrlSuccs->at(0)
             : longPathConditionNode;
 
-    auto bufferCount = 0;
     for (auto enode : *longPathConditionNode->CntrlSuccs)
-      tryInsertBuffer(enode, nextBB, condBB, depth, bufferCount, bufferDeclare,
-                      dotGraph, enode_dag);
+      tryInsertBuffer(enode, nextBB, condBB, depth, bufferCount, dotGraph,
+                      enode_dag);
     for (auto enode : *longPathConditionNode->JustCntrlSuccs)
-      tryInsertBuffer(enode, nextBB, condBB, depth, bufferCount, bufferDeclare,
-                      dotGraph, enode_dag);
-
-    bool foundBB = false;
-    for (auto i = 0; i < dotGraph.size(); i++)
-      if (dotGraph[i].find("label = \"block" + std::to_string(condBB) + "\"") !=
-          std::string::npos) {
-        dotGraph[i] += "\n" + bufferDeclare;
-        foundBB = true;
-        break;
-      }
-    assert(foundBB);
+      tryInsertBuffer(enode, nextBB, condBB, depth, bufferCount, dotGraph,
+                      enode_dag);
+
+    // The next if statements may be on cycles through the new buffers
+    nodes = getDotNodes(dotGraph);
   }
 }
 
@@ -613,10 +662,6 @@ void BufferIfStmtPass::getAnalysisUsage(AnalysisUsage &AU) const {
 
 bool BufferIfStmtPass::runOnModule(Module &M) {
 
-  auto mgs = getMarkedGraphInfo("./buff.log");
-  if (mgs.size() == 0)
-    return true;
-
   for (auto &F : M) {
     if (F.hasFnAttribute("dass_ss") || F.getName() == "main" || F.empty())
       continue;
@@ -627,16 +672,17 @@ bool BufferIfStmtPass::runOnModule(Module &M) {
       return true;
 
     auto fname = demangleFuncName(F.getName().str().c_str());
-    auto dotGraph = getDotGraph(fname + "_graph_buf_new.dot");
+    DotGraph dotGraph;
+    getDotGraph(fname + "_graph_buf_new.dot", dotGraph);
 
-    bufferIfStmt(ifBlocks, mgs, dotGraph, cdfg.enode_dag);
+    bufferIfStmt(ifBlocks, &F, cdfg.bbnode_dag, dotGraph, cdfg.enode_dag);
 
     system(
         ("mv " + fname + "_graph_buf_new.dot " + fname + "_graph_buf_new.dot_")
             .c_str());
-    std::ofstream ofile(fname + "_graph_buf_new.dot");
-    for (auto &s : dotGraph)
-      ofile << s << "\n";
+    std::error_code ec;
+    llvm::raw_fd_ostream ofile(fname + "_graph_buf_new.dot", ec);
+    dotGraph.write(ofile);
     ofile.close();
   }
   return true;
@@ -0,0 +1,247 @@
+#include "DotGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+static std::string trim(const std::string &s) {
+  auto first = s.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  auto last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+// Range of the value of "key=value" or "key = \"value\"" in text, npos if
+// the attribute is not found
+static std::pair<size_t, size_t> findAttr(const std::string &text,
+                                          const std::string &key) {
+  for (auto pos = text.find(key); pos != std::string::npos;
+       pos = text.find(key, pos + 1)) {
+    if (pos > 0 && text[pos - 1] != ' ' && text[pos - 1] != ',' &&
+        text[pos - 1] != '[')
+      continue;
+    auto eq = text.find_first_not_of(' ', pos + key.size());
+    if (eq == std::string::npos || text[eq] != '=')
+      continue;
+    auto begin = text.find_first_not_of(' ', eq + 1);
+    if (begin == std::string::npos)
+      break;
+    if (text[begin] == '"') {
+      begin++;
+      return {begin, text.find('"', begin)};
+    }
+    return {begin, text.find_first_of(" ,];", begin)};
+  }
+  return {std::string::npos, std::string::npos};
+}
+
+static bool setAttr(std::string &text, const std::string &key,
+                    const std::string &value) {
+  auto range = findAttr(text, key);
+  if (range.first == std::string::npos)
+    return false;
+  text.replace(range.first, range.second - range.first, value);
+  return true;
+}
+
+// Name token ending at the first delimiter, or at the closing quote
+static size_t getNameEnd(const std::string &s, size_t begin) {
+  if (s[begin] == '"')
+    return s.find('"', begin + 1) + 1;
+  return s.find_first_of(" [;", begin);
+}
+
+std::string DotGraph::getName(const std::string &node) {
+  if (node.size() >= 2 && node.front() == '"' && node.back() == '"')
+    return node.substr(1, node.size() - 2);
+  return node;
+}
+
+void DotGraph::read(std::istream &in) {
+  std::string line;
+  while (std::getline(in, line)) {
+    unsigned i = lines.size();
+    lines.push_back(line);
+    auto s = trim(line);
+    if (s.empty() || s.compare(0, 2, "//") == 0)
+      continue;
+
+    auto arrow = line.find("->");
+    if (arrow != std::string::npos) {
+      edges.emplace_back();
+      auto &edge = edges.back();
+      auto begin = line.find_first_not_of(" \t");
+      edge.indent = line.substr(0, begin);
+      edge.src = trim(line.substr(begin, arrow - begin));
+      auto dstBegin = line.find_first_not_of(' ', arrow + 2);
+      auto dstEnd = getNameEnd(line, dstBegin);
+      edge.dst = line.substr(dstBegin, dstEnd - dstBegin);
+      edge.attrs = (dstEnd == std::string::npos) ? "" : line.substr(dstEnd);
+      edge.line = i;
+      auto to = findAttr(edge.attrs, "to");
+      if (to.first != std::string::npos)
+        inEdgeIdx[getName(edge.dst) + ":" +
+                  edge.attrs.substr(to.first, to.second - to.first)] = &edge;
+      outEdgeIdx.emplace(getName(edge.src), &edge);
+      continue;
+    }
+
+    if (s.compare(0, 5, "label") == 0) {
+      auto pos = s.find("\"block");
+      if (pos != std::string::npos)
+        blockIdx[std::stoi(s.substr(pos + 6))] = i;
+      continue;
+    }
+
+    auto bracket = s.find('[');
+    if (bracket != std::string::npos && bracket > 0 &&
+        s.find('=') > bracket) {
+      auto end = getNameEnd(s, 0);
+      nodeIdx[getName(s.substr(0, std::min(end, bracket)))] = i;
+    }
+  }
+  isFollowing.assign(lines.size(), false);
+  isRemoved.assign(lines.size(), false);
+}
+
+void DotGraph::write(llvm::raw_ostream &out) const {
+  std::vector<unsigned> stack;
+  for (unsigned i = 0; i < lines.size(); i++) {
+    if (isFollowing[i])
+      continue;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      auto j = stack.back();
+      stack.pop_back();
+      if (!isRemoved[j])
+        out << lines[j] << "\n";
+      auto it = following.find(j);
+      if (it != following.end())
+        stack.insert(stack.end(), it->second.rbegin(), it->second.rend());
+    }
+  }
+}
+
+unsigned DotGraph::addLine(unsigned anchor, const std::string &text) {
+  unsigned i = lines.size();
+  lines.push_back(text);
+  isFollowing.push_back(true);
+  isRemoved.push_back(false);
+  following[anchor].push_back(i);
+  return i;
+}
+
+void DotGraph::updateEdge(Edge *edge) {
+  lines[edge->line] = edge->indent + edge->src + " -> " + edge->dst +
+                      edge->attrs;
+}
+
+DotGraph::Edge *DotGraph::getInEdge(const std::string &dst,
+                                    const std::string &port) {
+  auto it = inEdgeIdx.find(dst + ":" + port);
+  return (it == inEdgeIdx.end()) ? nullptr : it->second;
+}
+
+std::vector<DotGraph::Edge *> DotGraph::getOutEdges(const std::string &src) {
+  std::vector<Edge *> outEdges;
+  auto range = outEdgeIdx.equal_range(src);
+  for (auto it = range.first; it != range.second; it++)
+    outEdges.push_back(it->second);
+  std::sort(outEdges.begin(), outEdges.end(),
+            [](Edge *a, Edge *b) { return a->line < b->line; });
+  return outEdges;
+}
+
+void DotGraph::insertNode(Edge *edge, const std::string &node) {
+  auto to = findAttr(edge->attrs, "to");
+  auto port = edge->attrs.substr(to.first, to.second - to.first);
+  auto quote = (edge->src.front() == '"') ? "\"" : "";
+  auto name = quote + node + quote;
+
+  edges.push_back(*edge);
+  auto &out = edges.back();
+  out.src = name;
+  setAttr(out.attrs, "from", "out1");
+  out.line = addLine(edge->line, "");
+  updateEdge(&out);
+
+  edge->dst = name;
+  setAttr(edge->attrs, "to", "in1");
+  updateEdge(edge);
+
+  inEdgeIdx[getName(out.dst) + ":" + port] = &out;
+  inEdgeIdx[node + ":in1"] = edge;
+  outEdgeIdx.emplace(node, &out);
+}
+
+void DotGraph::bypassNode(const std::string &node) {
+  auto outEdges = getOutEdges(node);
+  assert(outEdges.size() == 1 && "Node to bypass has not a single output");
+  auto out = outEdges.front();
+  // Declared as in="in1:<width>"
+  auto inPort = getNodeAttr(node, "in");
+  inPort = inPort.empty() ? "in1" : inPort.substr(0, inPort.find(':'));
+  auto in = getInEdge(node, inPort);
+  assert(in && "Node to bypass has no input");
+
+  auto to = findAttr(out->attrs, "to");
+  auto port = out->attrs.substr(to.first, to.second - to.first);
+  in->dst = out->dst;
+  setAttr(in->attrs, "to", port);
+  updateEdge(in);
+
+  inEdgeIdx.erase(node + ":" + inPort);
+  inEdgeIdx[getName(out->dst) + ":" + port] = in;
+  outEdgeIdx.erase(node);
+  out->removed = true;
+  isRemoved[out->line] = true;
+  auto it = nodeIdx.find(node);
+  if (it != nodeIdx.end()) {
+    isRemoved[it->second] = true;
+    nodeIdx.erase(it);
+  }
+}
+
+std::vector<std::string> DotGraph::getNodes() const {
+  std::vector<std::string> nodes;
+  for (auto &node : nodeIdx)
+    nodes.push_back(node.first);
+  return nodes;
+}
+
+bool DotGraph::hasNode(const std::string &name) { return nodeIdx.count(name); }
+
+std::string DotGraph::getNodeAttr(const std::string &name,
+                                  const std::string &attr) {
+  auto it = nodeIdx.find(name);
+  if (it == nodeIdx.end())
+    return "";
+  auto &s = lines[it->second];
+  auto range = findAttr(s, attr);
+  if (range.first == std::string::npos)
+    return "";
+  return s.substr(range.first, range.second - range.first);
+}
+
+void DotGraph::setSlots(const std::string &name, int slots) {
+  auto it = nodeIdx.find(name);
+  assert(it != nodeIdx.end() && "Buffer to expand not found");
+  auto &s = lines[it->second];
+  setAttr(s, "slots", std::to_string(slots));
+  auto label = findAttr(s, "label");
+  if (label.first == std::string::npos)
+    return;
+  auto begin = s.find('[', label.first);
+  auto end = s.find("t]", begin);
+  if (begin < label.second && end < label.second)
+    s.replace(begin + 1, end - begin - 1, std::to_string(slots));
+}
+
+bool DotGraph::addNode(int bb, const std::string &name,
+                       const std::string &decl) {
+  auto it = blockIdx.find(bb);
+  if (it == blockIdx.end())
+    return false;
+  nodeIdx[name] = addLine(it->second, decl);
+  return true;
+}
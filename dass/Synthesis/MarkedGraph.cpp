@@ -0,0 +1,173 @@
+#include "MarkedGraph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+static const double eps = 1e-9;
+
+void MarkedGraph::addEdge(unsigned src, unsigned dst, double latency,
+                          unsigned tokens) {
+  succs[src].push_back({dst, latency, tokens});
+}
+
+// Howard's algorithm keeps one outgoing edge per node as the policy. Each
+// node of the policy graph leads to exactly one policy cycle, whose ratio is
+// the estimate eta of the node, and x is the potential of the node relative
+// to that cycle. The policy switches to the edges that lead to a higher
+// ratio, or to a higher potential at the same ratio, until it is stable.
+// The ratio of the best policy cycle is then the maximum cycle ratio.
+double MarkedGraph::getMaxCycleRatio() const {
+  unsigned n = succs.size();
+
+  // Only the nodes that reach a cycle have a policy: drop the nodes without
+  // any edge to the remaining ones
+  std::vector<std::vector<unsigned>> preds(n);
+  std::vector<unsigned> outDegree(n, 0);
+  for (unsigned u = 0; u < n; u++)
+    for (auto &e : succs[u]) {
+      preds[e.dst].push_back(u);
+      outDegree[u]++;
+    }
+  std::vector<bool> alive(n, true);
+  std::vector<unsigned> dead;
+  for (unsigned u = 0; u < n; u++)
+    if (outDegree[u] == 0)
+      dead.push_back(u);
+  while (!dead.empty()) {
+    auto v = dead.back();
+    dead.pop_back();
+    alive[v] = false;
+    for (auto u : preds[v])
+      if (--outDegree[u] == 0)
+        dead.push_back(u);
+  }
+
+  // Howard only evaluates the cycles its policies land on, so first check
+  // that the edges without tokens are acyclic, dropping the nodes without
+  // such an edge to the remaining ones as above
+  std::vector<std::vector<unsigned>> emptyPreds(n);
+  std::vector<unsigned> emptyDegree(n, 0);
+  for (unsigned u = 0; u < n; u++)
+    for (auto &e : succs[u])
+      if (alive[u] && alive[e.dst] && e.tokens == 0) {
+        emptyPreds[e.dst].push_back(u);
+        emptyDegree[u]++;
+      }
+  unsigned numAlive = std::count(alive.begin(), alive.end(), true);
+  for (unsigned u = 0; u < n; u++)
+    if (alive[u] && emptyDegree[u] == 0)
+      dead.push_back(u);
+  while (!dead.empty()) {
+    auto v = dead.back();
+    dead.pop_back();
+    numAlive--;
+    for (auto u : emptyPreds[v])
+      if (--emptyDegree[u] == 0)
+        dead.push_back(u);
+  }
+  if (numAlive != 0)
+    return std::numeric_limits<double>::infinity();
+
+  std::vector<const Edge *> policy(n, nullptr);
+  bool hasCycle = false;
+  for (unsigned u = 0; u < n; u++) {
+    if (!alive[u])
+      continue;
+    hasCycle = true;
+    for (auto &e : succs[u])
+      if (alive[e.dst] && (!policy[u] || e.latency > policy[u]->latency))
+        policy[u] = &e;
+  }
+  if (!hasCycle)
+    return 0;
+
+  std::vector<double> eta(n), x(n);
+  std::vector<unsigned> visit(n);
+  std::vector<std::vector<unsigned>> policyPreds(n);
+  std::vector<unsigned> queue;
+  while (true) {
+    // Value determination: find the cycle of each component of the policy
+    // graph and propagate its ratio and the potentials backwards
+    for (unsigned u = 0; u < n; u++)
+      policyPreds[u].clear();
+    for (unsigned u = 0; u < n; u++)
+      if (alive[u])
+        policyPreds[policy[u]->dst].push_back(u);
+    std::fill(visit.begin(), visit.end(), 0);
+    for (unsigned u = 0; u < n; u++) {
+      if (!alive[u] || visit[u])
+        continue;
+      auto v = u;
+      while (!visit[v]) {
+        visit[v] = u + 1;
+        v = policy[v]->dst;
+      }
+      // A new cycle is found only if the walk ends on its own path
+      if (visit[v] != u + 1)
+        continue;
+      double latency = 0;
+      unsigned tokens = 0;
+      auto w = v;
+      do {
+        latency += policy[w]->latency;
+        tokens += policy[w]->tokens;
+        w = policy[w]->dst;
+      } while (w != v);
+      assert(tokens > 0);
+      auto ratio = latency / tokens;
+
+      eta[v] = ratio;
+      x[v] = 0;
+      queue.assign(1, v);
+      while (!queue.empty()) {
+        auto dst = queue.back();
+        queue.pop_back();
+        for (auto src : policyPreds[dst]) {
+          if (src == v)
+            continue;
+          eta[src] = ratio;
+          x[src] = policy[src]->latency - ratio * policy[src]->tokens + x[dst];
+          queue.push_back(src);
+        }
+      }
+    }
+
+    // Policy improvement: prefer a higher ratio, then a higher potential
+    bool changed = false;
+    for (unsigned u = 0; u < n; u++) {
+      if (!alive[u])
+        continue;
+      for (auto &e : succs[u])
+        if (alive[e.dst] && eta[e.dst] > eta[policy[u]->dst] + eps) {
+          policy[u] = &e;
+          changed = true;
+        }
+    }
+    if (!changed)
+      for (unsigned u = 0; u < n; u++) {
+        if (!alive[u])
+          continue;
+        auto best = x[u];
+        for (auto &e : succs[u]) {
+          if (!alive[e.dst] || std::abs(eta[e.dst] - eta[u]) > eps)
+            continue;
+          auto value = e.latency - eta[u] * e.tokens + x[e.dst];
+          if (value > best + eps) {
+            best = value;
+            policy[u] = &e;
+            changed = true;
+          }
+        }
+      }
+    if (!changed)
+      break;
+  }
+
+  double ratio = 0;
+  for (unsigned u = 0; u < n; u++)
+    if (alive[u])
+      ratio = std::max(ratio, eta[u]);
+  return ratio;
+}
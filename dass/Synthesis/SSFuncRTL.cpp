@@ -0,0 +1,209 @@
+#include "SSFuncRTL.h"
+
+#include <cctype>
+#include <sstream>
+
+static std::string trim(const std::string &s) {
+  auto first = s.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  auto last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+static bool startsWith(const std::string &s, const std::string &prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+static void replaceAll(std::string &s, const std::string &from,
+                       const std::string &to) {
+  for (auto pos = s.find(from); pos != std::string::npos;
+       pos = s.find(from, pos + to.size()))
+    s.replace(pos, from.size(), to);
+}
+
+// Position of signal in s not preceded by another identifier character
+static size_t findSignal(const std::string &s, const std::string &signal,
+                         size_t pos = 0) {
+  for (pos = s.find(signal, pos); pos != std::string::npos;
+       pos = s.find(signal, pos + 1))
+    if (pos == 0 || (!std::isalnum(s[pos - 1]) && s[pos - 1] != '_'))
+      return pos;
+  return std::string::npos;
+}
+
+// State of the FSM in the condition of an assignment, -1 if none
+static int getState(const std::string &s) {
+  auto pos = s.find("ap_CS_fsm_state");
+  if (pos == std::string::npos)
+    return -1;
+  pos += 15;
+  auto end = pos;
+  while (end < s.size() && std::isdigit(s[end]))
+    end++;
+  return (end == pos) ? -1 : std::stoi(s.substr(pos, end - pos));
+}
+
+bool SSFuncRTL::readOffsets(const std::string &text) {
+  std::istringstream in(text);
+  std::string line;
+  bool isTop = false;
+  while (std::getline(in, line)) {
+    if (!isTop) {
+      if (startsWith(line, "Function: ")) {
+        auto name = line.substr(10, line.find(',') - 10);
+        isTop = (trim(name) == top);
+      }
+      continue;
+    }
+    if (line.find("---") != std::string::npos)
+      return true;
+
+    std::vector<std::string> fields;
+    std::istringstream fieldIn(line);
+    std::string field;
+    while (std::getline(fieldIn, field, ','))
+      fields.push_back(trim(field));
+    if (fields.size() < 7)
+      continue;
+    ports.push_back({fields[0], std::stoi(fields[1]), std::stoi(fields[2]),
+                     std::stoi(fields[3]), std::stoi(fields[4]),
+                     std::stoi(fields[5]), std::stoi(fields[6])});
+  }
+  return false;
+}
+
+bool SSFuncRTL::read(const std::string &text) {
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line))
+    lines.push_back(line);
+
+  auto head = isVHDL ? "entity " + top + " is" : "module " + top + " (";
+  auto size = lines.size();
+  unsigned i = 0;
+  while (i < size && lines[i].find(head) == std::string::npos)
+    i++;
+  if (i == size)
+    return false;
+  begin = i;
+
+  // Vitis HLS names the architecture behav
+  while (i < size && (isVHDL ? !startsWith(lines[i], "end behav")
+                             : lines[i].find("endmodule //" + top) ==
+                                   std::string::npos))
+    i++;
+  if (i == size)
+    return false;
+  end = i;
+  return true;
+}
+
+std::string SSFuncRTL::write() const {
+  std::string text;
+  for (auto &line : lines)
+    text += line + "\n";
+  return text;
+}
+
+std::pair<int, std::string>
+SSFuncRTL::getAssignedSignal(const std::string &signal) {
+  int useCount = 0, index = -1;
+  std::string result = signal;
+  for (auto i = begin; i <= end; i++) {
+    auto &s = lines[i];
+    auto pos = findSignal(s, signal + ";");
+    if (pos != std::string::npos && s.find("_read_reg_") != std::string::npos &&
+        s.find("= ") < pos) {
+      auto assign = s.find("<=");
+      if (assign == std::string::npos)
+        assign = s.find('=');
+      result = trim(s.substr(0, assign));
+      index = i;
+      useCount++;
+    } else if (isVHDL ? (findSignal(s, "=> " + signal + ",") !=
+                             std::string::npos ||
+                         findSignal(s, "=> " + signal + ")") !=
+                             std::string::npos)
+                      : s.find("(" + signal + "),") != std::string::npos)
+      useCount++;
+  }
+
+  // A register read by another operation as well has to be kept
+  if (useCount != 1)
+    return {-1, signal};
+  if (result.find("_read_reg_") == std::string::npos)
+    return {index, signal};
+  return {index, result};
+}
+
+void SSFuncRTL::rewriteInput(const OffsetPort &port,
+                             llvm::raw_ostream &log) {
+  int depth;
+  auto name = port.name;
+  while (true) {
+    auto next = getAssignedSignal(name);
+    auto state = (next.first > 0) ? getState(lines[next.first - 1]) : -1;
+    if (next.second == name) {
+      depth = state - 2;
+      break;
+    }
+    depth = state;
+    name = next.second;
+  }
+
+  if (depth != port.depth)
+    log << "Warning: Depth mismatched. please check: " << port.name
+        << ". Expected depth = " << port.depth << ". Found depth = " << depth
+        << "\nIgnore the above warning if the signal is connected to an "
+           "operator...\n";
+  log << port.name << " => " << name << "\n";
+  if (name == port.name)
+    return;
+
+  for (auto i = begin; i <= end; i++) {
+    auto &s = lines[i];
+    if (s.find(name) == std::string::npos)
+      continue;
+    replaceAll(s, "(" + name + ")", "(" + port.name + ")");
+    replaceAll(s, "= " + name + ";", "= " + port.name + ";");
+    if (isVHDL) {
+      replaceAll(s, "=> " + name + ",", "=> " + port.name + ",");
+      replaceAll(s, "=> " + name + ")", "=> " + port.name + ")");
+    }
+  }
+}
+
+void SSFuncRTL::removeShiftRegs(llvm::raw_ostream &log) {
+  for (auto &port : ports) {
+    if (port.depth == 0)
+      continue;
+    if (!port.isIn) {
+      log << "Short cutting output not implemented/tested yet\n";
+      continue;
+    }
+    rewriteInput(port, log);
+  }
+}
+
+void SSFuncRTL::removeClockEnables() {
+  std::vector<std::string> strobes, enables;
+  if (isVHDL) {
+    for (auto strobe : {"_ce0", "_ce1", "_we0", "_we1", "_write", "ap_done"})
+      strobes.push_back(std::string(strobe) + " <= ap_const_logic_1;");
+    enables = {" and (ap_const_logic_1 = ap_ce)",
+               "(ap_const_logic_1 = ap_ce) and "};
+  } else {
+    for (auto strobe : {"_ce0", "_ce1", "_we0", "_we1", "_write", "ap_done"})
+      strobes.push_back(std::string(strobe) + " = 1'b1;");
+    enables = {" & (1'b1 == ap_ce)", "(1'b1 == ap_ce) & "};
+  }
+
+  for (unsigned i = 1; i < lines.size(); i++)
+    for (auto &strobe : strobes)
+      if (lines[i].find(strobe) != std::string::npos) {
+        for (auto &enable : enables)
+          replaceAll(lines[i - 1], enable, "");
+        break;
+      }
+}
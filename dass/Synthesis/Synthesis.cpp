@@ -4,7 +4,8 @@
 // function.
 //
 // Pass: CollectRTLPass
-// Collect all the RTL files for ss functions into vhdl files
+// Collect all the RTL files for ss functions into vhdl files, removing the
+// shift registers of the offsets from the top of each function
 //
 // Pass: StaticIslandInsertionPass
 // Rewrite the output VHDL file from Dynamatic to construct memory interface
@@ -14,6 +15,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <fcntl.h>
+#include <omp.h>
+#include <sstream>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/Function.h"
@@ -21,6 +28,9 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "ElasticPass/Head.h"
@@ -28,7 +38,9 @@
 #include "Nodes.h"
 
 #include "AutopilotParser.h"
+#include "SSFuncRTL.h"
 #include "Synthesis.h"
+#include "VHDLNetlist.h"
 #include "VHDLPortParser.h"
 
 #define XSIM
@@ -36,7 +48,8 @@
 using namespace llvm;
 using namespace AutopilotParser;
 
-std::ofstream rtlOut;
+// Wrapper of the SS function being generated
+std::stringstream rtlOut;
 
 cl::opt<std::string> opt_irDir("ir_dir", cl::desc("Input LLVM IR file"),
                                cl::Hidden, cl::init("./vhls"), cl::Optional);
@@ -56,6 +69,77 @@ cl::opt<bool>
     opt_offset("has_offset",
                cl::desc("Added offset constraints to the SS functions"),
                cl::Hidden, cl::init(true), cl::Optional);
+cl::opt<std::string>
+    opt_rtlCache("rtl-cache",
+                 cl::desc("Directory of the cached wrappers and RTL of the SS "
+                          "functions, empty to always regenerate them"),
+                 cl::Hidden, cl::init("./.rtl_cache"), cl::Optional);
+cl::opt<int>
+    opt_rtlJobs("rtl-jobs",
+                cl::desc("Number of SS functions to collect the RTL of in "
+                         "parallel, 0 to use all the processors"),
+                cl::Hidden, cl::init(0), cl::Optional);
+
+//--------------------------------------------------------//
+// Build cache of the SS functions
+//--------------------------------------------------------//
+
+// Bump when the generated wrappers or the collected RTL change, e.g. with
+// SSFuncRTL
+static const std::string rtlCacheVersion = "2";
+
+static std::string readFile(std::string fileName) {
+  std::ifstream ifile(fileName);
+  std::stringstream buffer;
+  buffer << ifile.rdbuf();
+  return buffer.str();
+}
+
+// Write and rename, so concurrent runs never read a partial file
+static void writeFile(std::string fileName, std::string content) {
+  auto tmp = fileName + "." + std::to_string(getpid());
+  std::ofstream ofile(tmp);
+  ofile << content;
+  ofile.close();
+  sys::fs::rename(tmp, fileName);
+}
+
+static std::string getIR(Function *F) {
+  std::string ir;
+  llvm::raw_string_ostream os(ir);
+  F->print(os);
+  return os.str();
+}
+
+static std::string getCacheKey(std::string kind,
+                               ArrayRef<std::string> contents) {
+  MD5 hash;
+  hash.update(rtlCacheVersion);
+  hash.update(kind);
+  // Separate the contents so that moving bytes between them changes the key
+  for (auto &content : contents) {
+    hash.update(std::to_string(content.size()));
+    hash.update(content);
+  }
+  MD5::MD5Result result;
+  hash.final(result);
+  return opt_rtlCache + "/" + kind + "_" + result.digest().str().str();
+}
+
+// RTL files of the directory, i.e. *.v*, sorted by name
+static std::vector<std::string> getRTLFiles(std::string dir) {
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (sys::fs::directory_iterator it(dir, ec), end; it != end && !ec;
+       it.increment(ec)) {
+    auto name = sys::path::filename(it->path()).str();
+    if (name.find(".v") != std::string::npos &&
+        sys::fs::is_regular_file(it->path()))
+      files.push_back(name);
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
 
 //--------------------------------------------------------//
 // Pass declaration: SSWrapperPass
@@ -762,22 +846,41 @@ void SSWrapperPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<MyCFGPass>();
 }
 
+// The wrapper depends on the SS function, its Vitis HLS schedule and ports,
+// and on the call node in the dataflow graph of the DS function, which is
+// fully determined by the IR of the DS function
+static std::string getWrapperCacheKey(Function *F, std::string &dsFunc,
+                                      bool needSync) {
+  auto fname = F->getName().str();
+  return getCacheKey(
+      "wrapper",
+      {getIR(F), dsFunc, std::to_string(needSync), std::to_string(opt_offset),
+       readFile(opt_irDir + "/" + fname + "/solution1/.autopilot/db/" + fname +
+                ".verbose.sched.rpt"),
+       readFile(opt_irDir + "/" + fname + "/solution1/syn/vhdl/" + fname +
+                ".vhd")});
+}
+
 bool SSWrapperPass::runOnModule(Module &M) {
   assert(opt_irDir != "" && "Please specify the input LLVM IR file");
 
-  rtlOut.open("./rtl/wrappers.vhd", std::fstream::out);
-
   // Assume there is only one DS function
   std::vector<ENode *> *enode_dag;
   std::vector<SharedMemory *> sharedArrays;
+  std::string dsFunc;
   for (auto &F : M)
     if (F.getName() != "main" && !F.hasFnAttribute("dass_ss") && !F.empty()) {
       enode_dag = getAnalysis<MyCFGPass>(F).enode_dag;
       sharedArrays = getSharedArrays(&F);
+      dsFunc = getIR(&F);
     }
 
+  bool useCache = !opt_rtlCache.empty();
+  if (useCache)
+    sys::fs::create_directories(opt_rtlCache);
+
   auto ssCount = 0;
-  std::string offsetInfo;
+  std::string wrappers, offsetInfo;
   for (auto &F : M) {
     if (F.getName() == "main" || !F.hasFnAttribute("dass_ss"))
       continue;
@@ -793,17 +896,46 @@ bool SSWrapperPass::runOnModule(Module &M) {
         needSyncWith(callNode, F.getName().str(), sharedArrays, enode_dag);
     bool needSync = (branchName != "");
     llvm::errs() << F.getName().str() << " : " << needSync << "\n";
+    ssCount++;
+
+    // Reuse the wrapper and the offsets of an unchanged function
+    std::string key;
+    if (useCache) {
+      key = getWrapperCacheKey(&F, dsFunc, needSync);
+      if (sys::fs::exists(key + ".vhd") && sys::fs::exists(key + ".tcl")) {
+        llvm::errs() << F.getName().str() << " : wrapper cached\n";
+        wrappers += readFile(key + ".vhd");
+        offsetInfo += readFile(key + ".tcl");
+        continue;
+      }
+    }
 
     auto vPortInfo = parsePortInfoVHDL(&F, opt_irDir + "/");
     assert(enode_dag->size() > 0);
-    vhdlGen(offsetInfo, callNode, &F, vPortInfo, enode_dag, needSync);
-    ssCount++;
+    std::string funcOffsetInfo;
+    rtlOut.str("");
+    vhdlGen(funcOffsetInfo, callNode, &F, vPortInfo, enode_dag, needSync);
+    wrappers += rtlOut.str();
+    offsetInfo += funcOffsetInfo;
+    if (useCache) {
+      writeFile(key + ".tcl", funcOffsetInfo);
+      writeFile(key + ".vhd", rtlOut.str());
+    }
+  }
+
+  // Keep the files untouched if nothing changed
+  auto wrapperFile = "./rtl/wrappers.vhd";
+  if (!sys::fs::exists(wrapperFile) || readFile(wrapperFile) != wrappers) {
+    std::ofstream ofile(wrapperFile);
+    ofile << wrappers;
+    ofile.close();
   }
-  rtlOut.close();
 
-  if (offsetInfo != "") {
+  auto offsetFile = opt_irDir + "/ss_offset.tcl";
+  if (offsetInfo != "" && (!sys::fs::exists(offsetFile) ||
+                           readFile(offsetFile) != offsetInfo)) {
     std::error_code ec;
-    llvm::raw_fd_ostream outfile(opt_irDir + "/ss_offset.tcl", ec);
+    llvm::raw_fd_ostream outfile(offsetFile, ec);
     outfile << offsetInfo;
     outfile.close();
   }
@@ -827,51 +959,174 @@ public:
 };
 } // namespace
 
+// RTL of a SS function to collect. The log is printed once all the functions
+// are collected.
+struct RTLJob {
+  std::string fname, rtlDir, ipDir, key;
+  bool isCached = false;
+  bool success = true;
+  std::string log;
+};
+
+// The collected RTL depends on the RTL exported by Vitis HLS and the offsets
+static std::string getRTLCacheKey(RTLJob &job, const std::string &offsets) {
+  std::vector<std::string> contents = {opt_rtl, std::to_string(opt_hasIP),
+                                       offsets};
+  std::vector<std::string> dirs = {job.rtlDir};
+  if (opt_hasIP)
+    dirs.push_back(job.ipDir);
+  for (auto &dir : dirs)
+    for (auto &file : getRTLFiles(dir)) {
+      // Skip the output of the previous runs
+      if (file.compare(0, job.fname.size() + 5, job.fname + "_new.") == 0)
+        continue;
+      contents.push_back(file);
+      contents.push_back(readFile(dir + file));
+    }
+  return getCacheKey("rtl_" + job.fname, contents);
+}
+
+// Copy within the kernel, with sendfile where copy_file_range cannot be used,
+// e.g. across file systems on older kernels
+static bool copyFile(std::string from, std::string to) {
+  int in = open(from.c_str(), O_RDONLY);
+  if (in < 0)
+    return false;
+  struct stat st;
+  fstat(in, &st);
+  int out = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777);
+  if (out < 0) {
+    close(in);
+    return false;
+  }
+  off_t left = st.st_size;
+  bool useSendfile = false;
+  while (left > 0) {
+    auto n = useSendfile
+                 ? sendfile(out, in, nullptr, left)
+                 : copy_file_range(in, nullptr, out, nullptr, left, 0);
+    if (n < 0 && !useSendfile &&
+        (errno == EXDEV || errno == ENOSYS || errno == EINVAL)) {
+      useSendfile = true;
+      continue;
+    }
+    if (n <= 0)
+      break;
+    left -= n;
+  }
+  close(in);
+  close(out);
+  // Never leave a truncated file behind
+  if (left != 0)
+    unlink(to.c_str());
+  return left == 0;
+}
+
+// Returns false if a file is not completely copied
+static bool copyRTLFiles(std::string from, std::string to,
+                         std::vector<std::string> skip = {}) {
+  for (auto &file : getRTLFiles(from))
+    if (std::find(skip.begin(), skip.end(), file) == skip.end() &&
+        !copyFile(from + file, to + file))
+      return false;
+  return true;
+}
+
+static void collectRTL(RTLJob &job, const std::string &offsets) {
+  llvm::raw_string_ostream log(job.log);
+  if (job.isCached) {
+    log << job.fname << " : rtl cached\n";
+    if (!copyRTLFiles(job.key + "/", "./rtl/")) {
+      log << "Cannot copy the cached rtl in " << job.key << "\n";
+      job.success = false;
+    }
+    return;
+  }
+
+  // The valid rtl code is named as ${TOP}_new.v* instead of ${TOP}.v*
+  bool isVHDL = (opt_rtl == "vhdl");
+  auto ext = (isVHDL) ? ".vhd" : ".v";
+  auto top = job.fname + ext;
+  auto newTop = job.fname + "_new" + ext;
+  SSFuncRTL rtl(job.fname, isVHDL);
+  if (!rtl.read(readFile(job.rtlDir + top))) {
+    log << "Cannot find top level module " << job.fname << " in "
+        << job.rtlDir + top << "\n";
+    job.success = false;
+    return;
+  }
+  if (rtl.readOffsets(offsets))
+    rtl.removeShiftRegs(log);
+  rtl.removeClockEnables();
+  auto text = rtl.write();
+
+  // Leave out the old rtl code with shift registers
+  std::vector<std::string> dirs = {"./rtl/"};
+  if (!job.key.empty())
+    dirs.push_back(job.key + "." + std::to_string(getpid()) + "/");
+  for (auto &dir : dirs) {
+    sys::fs::create_directories(dir);
+    writeFile(dir + newTop, text);
+    if (!copyRTLFiles(job.rtlDir, dir, {top, newTop}) ||
+        (opt_hasIP && !copyRTLFiles(job.ipDir, dir))) {
+      log << "Cannot copy the rtl of " << job.fname << " to " << dir << "\n";
+      job.success = false;
+      break;
+    }
+  }
+
+  // Build the cache entry aside and rename it, so concurrent runs never read
+  // a partial entry. A failed copy is never cached.
+  if (!job.key.empty() &&
+      (!job.success || sys::fs::rename(dirs.back(), job.key)))
+    sys::fs::remove_directories(dirs.back());
+}
+
+// The functions are independent, so their RTL is collected in parallel
 bool CollectRTLPass::runOnModule(Module &M) {
 
   if (opt_rtl != "verilog" && opt_rtl != "vhdl")
     llvm_unreachable(
         "Cannot detect the rtl language. Please use verilog or vhdl.");
 
+  bool useCache = !opt_rtlCache.empty();
+  if (useCache)
+    sys::fs::create_directories(opt_rtlCache);
+
+  std::vector<RTLJob> jobs;
   for (auto &F : M) {
     auto fname = F.getName().str();
     if (fname == "main" || !F.hasFnAttribute("dass_ss"))
       continue;
 
-    std::string isSS = F.getFnAttribute("dass_ss").getValueAsString();
-    std::string cmd;
-
-    auto rtlDir = (opt_hasIP) ? opt_irDir + "/" + fname + "/solution1/syn/" +
-                                    opt_rtl + "/"
-                              : opt_irDir + "/" + fname +
-                                    "/solution1/impl/ip/hdl/" + opt_rtl + "/";
-
-    // The valid rtl code is named as ${TOP}_new.v* instead of ${TOP}.v*
-    auto DT = llvm::DominatorTree(F);
-    LoopInfo LI(DT);
-    if (opt_rtl == "verilog") {
-      cmd = "python3 " + opt_DASS + "/dass/scripts/OptimizeSSFunc.py " +
-            rtlDir + fname + ".v -t " + fname;
-      llvm::errs() << cmd << "\n";
-      system(cmd.c_str());
-    } else {
-      llvm_unreachable("Offset removal for vhdl code is not supported.");
-    }
+    jobs.emplace_back();
+    auto &job = jobs.back();
+    job.fname = fname;
+    job.rtlDir = (opt_hasIP) ? opt_irDir + "/" + fname + "/solution1/syn/" +
+                                   opt_rtl + "/"
+                             : opt_irDir + "/" + fname +
+                                   "/solution1/impl/ip/hdl/" + opt_rtl + "/";
+    job.ipDir = opt_irDir + "/" + fname + "/solution1/impl/ip/hdl/ip/";
+  }
 
-    cmd = "cp " + rtlDir + "*.v* ./rtl/";
-    system(cmd.c_str());
-    if (opt_hasIP)
-      cmd = "cp " + opt_irDir + "/" + fname +
-            "/solution1/impl/ip/hdl/ip/*.v* ./rtl/";
-    system(cmd.c_str());
-
-    // Remove the old rtl code with shift registers
-    if (opt_rtl == "verilog") {
-      cmd = "rm ./rtl/" + fname + ".v";
-      system(cmd.c_str());
-    } else {
-      llvm_unreachable("Offset removal for vhdl code is not supported.");
+  auto offsets = readFile(opt_irDir + "/ss_offset.tcl");
+  int threads = (opt_rtlJobs > 0) ? opt_rtlJobs : omp_get_num_procs();
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+  for (unsigned i = 0; i < jobs.size(); i++) {
+    auto &job = jobs[i];
+    // Reuse the RTL collected for an unchanged function
+    if (useCache) {
+      job.key = getRTLCacheKey(job, offsets);
+      job.isCached = sys::fs::is_directory(job.key);
     }
+    collectRTL(job, offsets);
+  }
+
+  for (auto &job : jobs) {
+    llvm::errs() << job.log;
+    if (!job.success)
+      llvm_unreachable(
+          std::string("Cannot collect the rtl of " + job.fname).c_str());
   }
   return true;
 }
@@ -880,70 +1135,53 @@ bool CollectRTLPass::runOnModule(Module &M) {
 // Pass declaration: StaticIslandInsertionPass
 //--------------------------------------------------------//
 
-static std::string getEmptyValidName(std::string name,
-                                     std::vector<std::string> &vhdlCode) {
-  for (auto &s : vhdlCode)
-    if (s.find("io_Empty_Valid => MC_" + name) != std::string::npos)
-      return s.substr(s.find("=>") + 3, s.find(",") - s.find("=>") - 3);
-
-  for (auto &s : vhdlCode)
-    if (s.find("io_Empty_Valid => LSQ_" + name) != std::string::npos)
-      return s.substr(s.find("=>") + 3, s.find(",") - s.find("=>") - 3);
-
+static std::string getEmptyValidName(std::string name, VHDLNetlist &netlist) {
+  for (auto comp : {"MC_", "LSQ_"}) {
+    auto inst = netlist.getInstance(comp + name);
+    if (inst && netlist.hasPort(inst, "io_Empty_Valid"))
+      return netlist.getPort(inst, "io_Empty_Valid");
+  }
   return "\'1\'";
 }
 
-static void rewriteMemory(SharedMemory *sm,
-                          std::vector<std::string> &vhdlCode) {
+static void rewriteMemory(SharedMemory *sm, VHDLNetlist &netlist) {
   auto name = sm->name;
-  auto i = 0;
 
-  while (i < vhdlCode.size() &&
-         vhdlCode[i].find("MC_" + name + ": ") == std::string::npos)
-    i++;
   // Special case where only a LSQ is needed
-  auto hasMC = (i == vhdlCode.size()) ? false : true;
-
-  i = 0;
-  while (vhdlCode[i].find("architecture behavioral of " + opt_top + " is") ==
-         std::string::npos)
-    i++;
-  i++;
+  auto hasMC = (netlist.getInstance("MC_" + name) != nullptr);
 
   // Add new signals
-  vhdlCode[i] +=
-      "\n\tsignal DA_" + name + "_clk: std_logic;\n\tsignal DA_" + name +
-      "_rst: std_logic;\n\tsignal DA_" + name +
-      "_valid: std_logic;\n\tsignal DA_" + name +
-      "_ready: std_logic;\n\tsignal DA_" + name +
-      "_ss_start: std_logic_vector(" + std::to_string(sm->ports - 1) +
-      " downto 0);\n\tsignal DA_" + name + "_ss_done: std_logic_vector(" +
-      std::to_string(sm->ports - 1) + " downto 0);\n\tsignal DA_" + name +
-      "_ss_ce: std_logic_vector(" + std::to_string(sm->ports - 1) +
-      " downto 0);\n\tsignal DA_" + name + "_we0_ce0: std_logic;\n";
+  auto range = "(" + std::to_string(sm->ports - 1) + " downto 0)";
+  netlist.addSignal("signal DA_" + name + "_clk: std_logic");
+  netlist.addSignal("signal DA_" + name + "_rst: std_logic");
+  netlist.addSignal("signal DA_" + name + "_valid: std_logic");
+  netlist.addSignal("signal DA_" + name + "_ready: std_logic");
+  netlist.addSignal("signal DA_" + name + "_ss_start: std_logic_vector" +
+                    range);
+  netlist.addSignal("signal DA_" + name + "_ss_done: std_logic_vector" +
+                    range);
+  netlist.addSignal("signal DA_" + name + "_ss_ce: std_logic_vector" + range);
+  netlist.addSignal("signal DA_" + name + "_we0_ce0: std_logic");
   for (auto j = 0; j < sm->ports; j++) {
-    vhdlCode[i] +=
-        "\tsignal DA_" + name + "_storeDataOut_" + std::to_string(j) +
-        ": std_logic_vector(31 downto 0);\n\tsignal DA_" + name +
-        "_storeAddrOut_" + std::to_string(j) +
-        ": std_logic_vector(31 downto 0);\n\tsignal DA_" + name +
-        "_storeEnable_" + std::to_string(j) + ": std_logic;\n\tsignal DA_" +
-        name + "_loadDataIn_" + std::to_string(j) +
-        ": std_logic_vector(31 downto 0);\n\tsignal DA_" + name +
-        "_loadAddrOut_" + std::to_string(j) +
-        ": std_logic_vector(31 downto 0);\n\tsignal DA_" + name +
-        "_loadEnable_" + std::to_string(j) + ": std_logic;\n";
+    auto idx = std::to_string(j);
+    netlist.addSignal("signal DA_" + name + "_storeDataOut_" + idx +
+                      ": std_logic_vector(31 downto 0)");
+    netlist.addSignal("signal DA_" + name + "_storeAddrOut_" + idx +
+                      ": std_logic_vector(31 downto 0)");
+    netlist.addSignal("signal DA_" + name + "_storeEnable_" + idx +
+                      ": std_logic");
+    netlist.addSignal("signal DA_" + name + "_loadDataIn_" + idx +
+                      ": std_logic_vector(31 downto 0)");
+    netlist.addSignal("signal DA_" + name + "_loadAddrOut_" + idx +
+                      ": std_logic_vector(31 downto 0)");
+    netlist.addSignal("signal DA_" + name + "_loadEnable_" + idx +
+                      ": std_logic");
   }
 
   // Add dassArbiter components
-  i = 0;
-  while (i < vhdlCode.size() &&
-         vhdlCode[i].find("end behavioral; ") == std::string::npos)
-    i++;
-  i--;
   std::string comp = (hasMC) ? "MC" : "LSQ";
-  vhdlCode[i] +=
-      "\nDA_" + name + ": entity work.dassArbiter(arch) generic map (32,32," +
+  std::string arbiter =
+      "DA_" + name + ": entity work.dassArbiter(arch) generic map (32,32," +
       std::to_string(sm->ports) + ")\nport map(\n\tclk => DA_" + name +
       "_clk,\n\trst => DA_" + name + "_rst,\n\tio_storeDataOut => " + name +
       "_dout0,\n\tio_storeAddrOut => " + name +
@@ -951,127 +1189,107 @@ static void rewriteMemory(SharedMemory *sm,
       "_we0_ce0,\n\tio_loadDataIn => " + name + "_din1,\n\tio_loadAddrOut => " +
       name + "_address1,\n\tio_loadEnable => " + name + "_ce1,\n";
   for (auto j = 0; j < sm->ports; j++)
-    vhdlCode[i] += "\tstoreDataOut(" + std::to_string(j * 32 + 31) +
-                   " downto " + std::to_string(j * 32) + ") => DA_" + name +
-                   "_storeDataOut_" + std::to_string(j) + ",\n";
+    arbiter += "\tstoreDataOut(" + std::to_string(j * 32 + 31) + " downto " +
+               std::to_string(j * 32) + ") => DA_" + name + "_storeDataOut_" +
+               std::to_string(j) + ",\n";
   for (auto j = 0; j < sm->ports; j++)
-    vhdlCode[i] += "\tstoreAddrOut(" + std::to_string(j * 32 + 31) +
-                   " downto " + std::to_string(j * 32) + ") => DA_" + name +
-                   "_storeAddrOut_" + std::to_string(j) + ",\n";
+    arbiter += "\tstoreAddrOut(" + std::to_string(j * 32 + 31) + " downto " +
+               std::to_string(j * 32) + ") => DA_" + name + "_storeAddrOut_" +
+               std::to_string(j) + ",\n";
   for (auto j = 0; j < sm->ports; j++)
-    vhdlCode[i] += "\tstoreEnable(" + std::to_string(j) + ") => DA_" + name +
-                   "_storeEnable_" + std::to_string(j) + ",\n";
+    arbiter += "\tstoreEnable(" + std::to_string(j) + ") => DA_" + name +
+               "_storeEnable_" + std::to_string(j) + ",\n";
   for (auto j = 0; j < sm->ports; j++)
-    vhdlCode[i] += "\tloadDataIn(" + std::to_string(j * 32 + 31) + " downto " +
-                   std::to_string(j * 32) + ") => DA_" + name + "_loadDataIn_" +
-                   std::to_string(j) + ",\n";
+    arbiter += "\tloadDataIn(" + std::to_string(j * 32 + 31) + " downto " +
+               std::to_string(j * 32) + ") => DA_" + name + "_loadDataIn_" +
+               std::to_string(j) + ",\n";
   for (auto j = 0; j < sm->ports; j++)
-    vhdlCode[i] += "\tloadAddrOut(" + std::to_string(j * 32 + 31) + " downto " +
-                   std::to_string(j * 32) + ") => DA_" + name +
-                   "_loadAddrOut_" + std::to_string(j) + ",\n";
+    arbiter += "\tloadAddrOut(" + std::to_string(j * 32 + 31) + " downto " +
+               std::to_string(j * 32) + ") => DA_" + name + "_loadAddrOut_" +
+               std::to_string(j) + ",\n";
   for (auto j = 0; j < sm->ports; j++)
-    vhdlCode[i] += "\tloadEnable(" + std::to_string(j) + ") => DA_" + name +
-                   "_loadEnable_" + std::to_string(j) + ",\n";
-
-  vhdlCode[i] += "\tio_Empty_Valid => DA_" + name + "_valid,\n\tready => DA_" +
-                 name + "_ready,\n\tss_start => DA_" + name +
-                 "_ss_start,\n\tss_ce => DA_" + name +
-                 "_ss_ce,\n\tss_done => DA_" + name + "_ss_done\n);\n";
+    arbiter += "\tloadEnable(" + std::to_string(j) + ") => DA_" + name +
+               "_loadEnable_" + std::to_string(j) + ",\n";
+  arbiter += "\tio_Empty_Valid => DA_" + name + "_valid,\n\tready => DA_" +
+             name + "_ready,\n\tss_start => DA_" + name +
+             "_ss_start,\n\tss_ce => DA_" + name + "_ss_ce,\n\tss_done => DA_" +
+             name + "_ss_done\n);\n";
+  netlist.addInstance(arbiter);
 
   // Overwrite ce & we
-  auto j = 0;
-  while (j < vhdlCode.size() &&
-         vhdlCode[j].find(name + "_we0 <= ") == std::string::npos)
-    j++;
-  if (j == vhdlCode.size())
-    vhdlCode[i] += "\t" + name + "_we0 <= DA_" + name + "_we0_ce0;\n";
-  else
-    vhdlCode[j] = "\t" + name + "_we0 <= DA_" + name + "_we0_ce0;";
-  j = 0;
-  while (j < vhdlCode.size() &&
-         vhdlCode[j].find(name + "_ce0 <= ") == std::string::npos)
-    j++;
-  if (j == vhdlCode.size())
-    vhdlCode[i] += "\t" + name + "_ce0 <= DA_" + name + "_we0_ce0;\n";
-  else
-    vhdlCode[j] = "\t" + name + "_ce0 <= DA_" + name + "_we0_ce0;";
+  netlist.setAssignment(name + "_we0", "DA_" + name + "_we0_ce0");
+  netlist.setAssignment(name + "_ce0", "DA_" + name + "_we0_ce0");
 
   // Have ds memory
   if (sm->inDS) {
     // Rewrite memcont interface
-    i = 0;
-    while (i < vhdlCode.size() &&
-           vhdlCode[i].find(comp + "_" + name + ": ") == std::string::npos)
-      i++;
-    assert(i < vhdlCode.size());
-
-    while (vhdlCode[i].find("io_storeDataOut => ") == std::string::npos)
-      i++;
-    vhdlCode[i] = "\tio_storeDataOut => DA_" + name + "_storeDataOut_0,";
-    vhdlCode[i + 1] = "\tio_storeAddrOut => DA_" + name + "_storeAddrOut_0,";
-    vhdlCode[i + 2] = "\tio_storeEnable => DA_" + name + "_storeEnable_0,";
-    vhdlCode[i + 3] = "\tio_loadDataIn => DA_" + name + "_loadDataIn_0,";
-    vhdlCode[i + 4] = "\tio_loadAddrOut => DA_" + name + "_loadAddrOut_0,";
-    vhdlCode[i + 5] = "\tio_loadEnable => DA_" + name + "_loadEnable_0,";
+    auto memcont = netlist.getInstance(comp + "_" + name);
+    assert(memcont);
+    netlist.setPort(memcont, "io_storeDataOut",
+                    "DA_" + name + "_storeDataOut_0");
+    netlist.setPort(memcont, "io_storeAddrOut",
+                    "DA_" + name + "_storeAddrOut_0");
+    netlist.setPort(memcont, "io_storeEnable", "DA_" + name + "_storeEnable_0");
+    netlist.setPort(memcont, "io_loadDataIn", "DA_" + name + "_loadDataIn_0");
+    netlist.setPort(memcont, "io_loadAddrOut", "DA_" + name + "_loadAddrOut_0");
+    netlist.setPort(memcont, "io_loadEnable", "DA_" + name + "_loadEnable_0");
   } else {
     // Rewrite top memory interface
-    i = 0;
-    while (vhdlCode[i].find("entity " + opt_top + " is") == std::string::npos)
-      i++;
-    i++;
-    vhdlCode[i] +=
-        "\n\t" + name + "_address0 : out std_logic_vector (31 downto 0);\n\t" +
-        name + "_ce0 : out std_logic;\n\t" + name +
-        "_we0 : out std_logic;\n\t" + name +
-        "_dout0 : out std_logic_vector (31 downto 0);\n\t" + name +
-        "_din0 : in std_logic_vector (31 downto 0);\n\t" + name +
-        "_address1 : out std_logic_vector (31 downto 0);\n\t" + name +
-        "_ce1 : out std_logic;\n\t" + name + "_we1 : out std_logic;\n\t" +
-        name + "_dout1 : out std_logic_vector (31 downto 0);\n\t" + name +
-        "_din1 : in std_logic_vector (31 downto 0);";
+    netlist.addEntityPort(name +
+                          "_address0 : out std_logic_vector (31 downto 0)");
+    netlist.addEntityPort(name + "_ce0 : out std_logic");
+    netlist.addEntityPort(name + "_we0 : out std_logic");
+    netlist.addEntityPort(name + "_dout0 : out std_logic_vector (31 downto 0)");
+    netlist.addEntityPort(name + "_din0 : in std_logic_vector (31 downto 0)");
+    netlist.addEntityPort(name +
+                          "_address1 : out std_logic_vector (31 downto 0)");
+    netlist.addEntityPort(name + "_ce1 : out std_logic");
+    netlist.addEntityPort(name + "_we1 : out std_logic");
+    netlist.addEntityPort(name + "_dout1 : out std_logic_vector (31 downto 0)");
+    netlist.addEntityPort(name + "_din1 : in std_logic_vector (31 downto 0)");
   }
 
   // Rewrite memcont interface for ss
   int index = sm->inDS;
   std::map<std::string, std::string> opMap;
+  auto emptyValidName = getEmptyValidName(name, netlist);
+  llvm::errs() << name << " " << emptyValidName << "\n";
   for (auto &call : sm->funcNames) {
-    i = 0;
-    while (vhdlCode[i].find("call_" + call + "(arch)") == std::string::npos)
-      i++;
-    opMap[call] = vhdlCode[i].substr(0, vhdlCode[i].find(":"));
-    i++;
-
-    auto emptyValidName = getEmptyValidName(name, vhdlCode);
-    llvm::errs() << name << " " << emptyValidName << "\n";
-    vhdlCode[i] +=
-        "\n\t" + name + "_address0 => DA_" + name + "_storeAddrOut_" +
-        std::to_string(index) + ",\n\t" + name + "_we_ce0 => DA_" + name +
-        "_storeEnable_" + std::to_string(index) + ",\n\t" + name +
-        "_dout0 => DA_" + name + "_storeDataOut_" + std::to_string(index) +
-        ",\n\t" + name + "_address1 => DA_" + name + "_loadAddrOut_" +
-        std::to_string(index) + ",\n\t" + name + "_ce1 => DA_" + name +
-        "_loadEnable_" + std::to_string(index) + ",\n\t" + name +
-        "_din1 => DA_" + name + "_loadDataIn_" + std::to_string(index) +
-        ",\n\t" + name + "_empty_valid => " + emptyValidName + ",\n";
+    auto inst = netlist.getInstanceOf("call_" + call);
+    if (!inst)
+      llvm_unreachable(
+          std::string("Cannot find instance of call_" + call + " in vhdl.\n")
+              .c_str());
+    opMap[call] = inst->name;
+
+    auto idx = std::to_string(index);
+    netlist.addPort(inst, name + "_address0",
+                    "DA_" + name + "_storeAddrOut_" + idx);
+    netlist.addPort(inst, name + "_we_ce0",
+                    "DA_" + name + "_storeEnable_" + idx);
+    netlist.addPort(inst, name + "_dout0",
+                    "DA_" + name + "_storeDataOut_" + idx);
+    netlist.addPort(inst, name + "_address1",
+                    "DA_" + name + "_loadAddrOut_" + idx);
+    netlist.addPort(inst, name + "_ce1", "DA_" + name + "_loadEnable_" + idx);
+    netlist.addPort(inst, name + "_din1", "DA_" + name + "_loadDataIn_" + idx);
+    netlist.addPort(inst, name + "_empty_valid", emptyValidName);
     index++;
   }
 
   // Add connections
-  i = 0;
-  while (vhdlCode[i].find("begin") == std::string::npos)
-    i++;
-  i++;
   index = sm->inDS;
-  vhdlCode[i] +=
-      "\tDA_" + name + "_clk <= clk;\n\tDA_" + name + "_rst <= rst;\n";
-  if (index)
-    vhdlCode[i] += "\tDA_" + name + "_ss_start(0) <= '0';\n\tDA_" + name +
-                   "_ss_done(0) <= '0';\n";
+  netlist.addStatement("DA_" + name + "_clk <= clk");
+  netlist.addStatement("DA_" + name + "_rst <= rst");
+  if (index) {
+    netlist.addStatement("DA_" + name + "_ss_start(0) <= '0'");
+    netlist.addStatement("DA_" + name + "_ss_done(0) <= '0'");
+  }
   for (auto &call : sm->funcNames) {
-    vhdlCode[i] += "\tDA_" + name + "_ss_start(" + std::to_string(index) +
-                   ") <= " + opMap[call] + "_start;\n\tDA_" + name +
-                   "_ss_done(" + std::to_string(index) + ") <= " + opMap[call] +
-                   "_done;\n";
+    netlist.addStatement("DA_" + name + "_ss_start(" + std::to_string(index) +
+                         ") <= " + opMap[call] + "_start");
+    netlist.addStatement("DA_" + name + "_ss_done(" + std::to_string(index) +
+                         ") <= " + opMap[call] + "_done");
     index++;
   }
 
@@ -1087,219 +1305,154 @@ static bool replace(std::string &str, const std::string &from,
   return true;
 }
 
-static void rewriteCall(std::vector<std::string> &vhdlCode) {
+static void rewriteCall(VHDLNetlist &netlist) {
   std::map<std::string, std::string> callNames;
-  auto i = 0;
-  for (auto &s : vhdlCode) {
-    if (s.find("call_") != std::string::npos &&
-        s.find(": entity work.call_") != std::string::npos) {
-      auto name = s.substr(0, s.find(":"));
-      auto j = i;
-      std::string ce = "'1'";
-      while (vhdlCode[j].find(");") == std::string::npos) {
-        std::string line = vhdlCode[j];
-        while (line.find("address0") != std::string::npos) {
-          auto sig = line.substr(line.find("=> ") + 3,
-                                 line.find(",") - line.find("=> ") - 3);
-          replace(sig, "storeAddrOut", "ss_ce");
-          for (auto k = sig.size() - 1; k >= 0; k--) {
-            if (sig[k] == '_') {
-              sig[k] = '(';
-              break;
-            }
-          }
-          ce += " and " + sig + ")";
-          line = line.substr(line.find("\n", line.find("_empty_valid")));
-        }
-        j++;
-      }
-      callNames[name] = ce;
-      vhdlCode[i + 1] += "\n\tstart => " + name + "_start,\n\tdone => " + name +
-                         "_done,\n\tce => " + name + "_ce,\n";
+  for (auto &inst : netlist.getInstances()) {
+    if (inst.entity.find("call_") != 0)
+      continue;
+    // Each shared array adds a store port DA_<array>_storeAddrOut_<i>, whose
+    // arbiter clock enable is DA_<array>_ss_ce(<i>)
+    std::string ce = "'1'";
+    for (auto &port : inst.newPorts) {
+      if (port.first.find("address0") == std::string::npos)
+        continue;
+      auto sig = port.second;
+      replace(sig, "storeAddrOut", "ss_ce");
+      sig[sig.rfind('_')] = '(';
+      ce += " and " + sig + ")";
     }
-    i++;
+    callNames[inst.name] = ce;
+    netlist.addPort(&inst, "start", inst.name + "_start");
+    netlist.addPort(&inst, "done", inst.name + "_done");
+    netlist.addPort(&inst, "ce", inst.name + "_ce");
   }
 
-  i = 0;
-  while (vhdlCode[i].find("architecture behavioral of " + opt_top + " is") ==
-         std::string::npos)
-    i++;
-  i++;
-  for (const auto &c : callNames)
-    vhdlCode[i] += "\tsignal " + c.first + "_start : std_logic;\n\tsignal " +
-                   c.first + "_done : std_logic;\n\tsignal " + c.first +
-                   "_ce : std_logic;\n";
+  for (const auto &c : callNames) {
+    netlist.addSignal("signal " + c.first + "_start : std_logic");
+    netlist.addSignal("signal " + c.first + "_done : std_logic");
+    netlist.addSignal("signal " + c.first + "_ce : std_logic");
+  }
 
-  i = 0;
-  while (vhdlCode[i].find("begin") == std::string::npos)
-    i++;
-  i++;
   for (const auto &c : callNames)
-    vhdlCode[i] += "\t" + c.first + "_ce <= " + c.second + ";\n";
+    netlist.addStatement(c.first + "_ce <= " + c.second);
 }
 
 static void rewriteMC(ArrayRef<SharedMemory *> sharedArrays,
-                      std::vector<std::string> &vhdlCode) {
+                      VHDLNetlist &netlist) {
+  auto isShared = [&](std::string name) {
+    for (auto const &sa : sharedArrays)
+      if (sa->name == name)
+        return true;
+    return false;
+  };
+
   std::vector<std::string> names;
-  for (auto i = 0; i < vhdlCode.size(); i++) {
-    auto s = vhdlCode[i];
-    if (s.find("MC_") != std::string::npos &&
-        s.find(": entity work.MemCont(arch) generic map") !=
-            std::string::npos) {
-      auto name = s.substr(s.find("MC_") + 3, s.find(":") - s.find("MC_") - 3);
-      names.push_back(name);
-      bool search = false;
-      for (auto const &sa : sharedArrays) {
-        if (sa->name == name) {
-          search = true;
-          break;
-        }
-      }
-      if (search)
-        vhdlCode[i + 1] += "\n\tce => DA_" + name + "_ss_ce(0),\n";
-      else
-        vhdlCode[i + 1] += "\n\tce => '1',\n";
-    }
+  for (auto &inst : netlist.getInstances()) {
+    if (inst.entity != "MemCont" || inst.name.find("MC_") != 0)
+      continue;
+    auto name = inst.name.substr(3);
+    names.push_back(name);
+    if (isShared(name))
+      netlist.addPort(&inst, "ce", "DA_" + name + "_ss_ce(0)");
+    else
+      netlist.addPort(&inst, "ce", "'1'");
   }
 
   // Special case: only LSQ is used without MC
-  for (auto i = 0; i < vhdlCode.size(); i++) {
-    auto s = vhdlCode[i];
-    if (s.find("LSQ_") != std::string::npos &&
-        s.find(": entity work.LSQ_") != std::string::npos) {
-      auto name =
-          s.substr(s.find("LSQ_") + 4, s.find(":") - s.find("LSQ_") - 4);
-      if (std::find(names.begin(), names.end(), name) != names.end())
-        continue;
-
-      bool search = false;
-      for (auto const &sa : sharedArrays)
-        if (sa->name == name) {
-          search = true;
-          break;
-        }
-
-      if (!search)
-        continue;
+  for (auto &inst : netlist.getInstances()) {
+    if (inst.entity.find("LSQ_") != 0 || inst.name.find("LSQ_") != 0)
+      continue;
+    auto name = inst.name.substr(4);
+    if (std::find(names.begin(), names.end(), name) != names.end())
+      continue;
+    if (!isShared(name))
+      continue;
 
-      auto j = i;
-      while (vhdlCode[j].find("io_memIsReadyForLoads => ") == std::string::npos)
-        j++;
-      vhdlCode[j] = "\tio_memIsReadyForLoads => DA_" + name + "_ss_ce(0),";
-      vhdlCode[j + 1] = "\tio_memIsReadyForStores => DA_" + name + "_ss_ce(0),";
-    }
+    netlist.setPort(&inst, "io_memIsReadyForLoads",
+                    "DA_" + name + "_ss_ce(0)");
+    netlist.setPort(&inst, "io_memIsReadyForStores",
+                    "DA_" + name + "_ss_ce(0)");
   }
 }
 
 static void rewriteEnd(ArrayRef<SharedMemory *> sharedArrays,
-                       std::vector<std::string> &vhdlCode) {
-  auto i = 0;
-  while (vhdlCode[i].find("work.end_node") == std::string::npos)
-    i++;
-  auto constraint = vhdlCode[i].substr(vhdlCode[i].rfind("("));
+                       VHDLNetlist &netlist) {
+  auto end = netlist.getInstanceOf("end_node");
+  if (!end)
+    llvm_unreachable("Cannot find end_node in vhdl.\n");
+  auto &header = netlist.getHeader(end);
+  auto constraint = header.substr(header.rfind("("));
   constraint =
       constraint.substr(constraint.find("(1,") + 3,
                         constraint.find(",", constraint.find("(1,") + 3) -
                             constraint.find("(1,") - 3);
   auto eCount = std::stoi(constraint);
-  replace(vhdlCode[i], "(1," + constraint + ",",
+  replace(header, "(1," + constraint + ",",
           "(1," + std::to_string(eCount + sharedArrays.size()) + ",");
-  while (i < vhdlCode.size() &&
-         vhdlCode[i].find("eValidArray(" + std::to_string(eCount - 1) +
-                          ") => ") == std::string::npos)
-    i++;
-  if (i == vhdlCode.size()) {
-    i = 0;
-    while (vhdlCode[i].find("work.end_node") == std::string::npos)
-      i++;
-    i++;
-  }
-  auto noEline = i;
-  vhdlCode[i] += "\n";
+  // Extend the arrays after their last element
+  auto validLast = "eValidArray(" + std::to_string(eCount - 1) + ")";
+  auto readyLast = "eReadyArray(" + std::to_string(eCount - 1) + ")";
+  if (!netlist.hasPort(end, readyLast))
+    readyLast = validLast;
   for (auto j = 0; j < sharedArrays.size(); j++)
-    vhdlCode[i] += "\teValidArray(" + std::to_string(j + eCount) +
-                   ") => end_0_pValidArray_" + std::to_string(j + eCount + 1) +
-                   ",\n";
-  while (i < vhdlCode.size() &&
-         vhdlCode[i].find("eReadyArray(" + std::to_string(eCount - 1) +
-                          ") => ") == std::string::npos)
-    i++;
-  if (i == vhdlCode.size())
-    i = noEline;
-  vhdlCode[i] += "\n";
+    netlist.addPortAfter(end, validLast,
+                         "eValidArray(" + std::to_string(j + eCount) + ")",
+                         "end_0_pValidArray_" + std::to_string(j + eCount + 1));
   for (auto j = 0; j < sharedArrays.size(); j++)
-    vhdlCode[i] += "\teReadyArray(" + std::to_string(j + eCount) +
-                   ") => end_0_readyArray_" + std::to_string(j + eCount + 1) +
-                   ",\n";
-
-  i = 0;
-  while (vhdlCode[i].find("architecture behavioral of " + opt_top + " is") ==
-         std::string::npos)
-    i++;
-  i++;
-
-  for (auto j = 0; j < sharedArrays.size(); j++)
-    vhdlCode[i] += "\tsignal end_0_pValidArray_" +
-                   std::to_string(j + eCount + 1) +
-                   " : std_logic;\n\tsignal "
-                   "end_0_readyArray_" +
-                   std::to_string(j + eCount + 1) + " : std_logic;\n";
-
-  i = 0;
-  while (vhdlCode[i].find("begin") == std::string::npos)
-    i++;
-  i++;
+    netlist.addPortAfter(end, readyLast,
+                         "eReadyArray(" + std::to_string(j + eCount) + ")",
+                         "end_0_readyArray_" + std::to_string(j + eCount + 1));
+  for (auto j = 0; j < sharedArrays.size(); j++) {
+    netlist.addSignal("signal end_0_pValidArray_" +
+                      std::to_string(j + eCount + 1) + " : std_logic");
+    netlist.addSignal("signal end_0_readyArray_" +
+                      std::to_string(j + eCount + 1) + " : std_logic");
+  }
 
   for (auto j = 0; j < sharedArrays.size(); j++)
-    vhdlCode[i] += "\tend_0_pValidArray_" + std::to_string(j + eCount + 1) +
-                   " <= DA_" + sharedArrays[j]->name + "_valid;\n";
+    netlist.addStatement("end_0_pValidArray_" + std::to_string(j + eCount + 1) +
+                         " <= DA_" + sharedArrays[j]->name + "_valid");
 }
 
-static void addMemoryArbitrationLogic(std::vector<std::string> &vhdlCode,
+static void addMemoryArbitrationLogic(VHDLNetlist &netlist,
                                       ArrayRef<SharedMemory *> sharedArrays) {
   for (auto sa : sharedArrays)
-    rewriteMemory(sa, vhdlCode);
-  rewriteCall(vhdlCode);
-  rewriteMC(sharedArrays, vhdlCode);
-  rewriteEnd(sharedArrays, vhdlCode);
+    rewriteMemory(sa, netlist);
+  rewriteCall(netlist);
+  rewriteMC(sharedArrays, netlist);
+  rewriteEnd(sharedArrays, netlist);
 }
 
 void syncCall(std::string callName, std::string branchName,
-              std::vector<std::string> &vhdlCode) {
+              VHDLNetlist &netlist) {
   auto sync_out_valid = branchName + "_pValidArray_0";
   auto sync_out_ready = branchName + "_readyArray_0";
 
-  auto i = 0;
-  while (i < vhdlCode.size() &&
-         vhdlCode[i].find(sync_out_valid + " <= ") == std::string::npos)
-    i++;
-  if (i == vhdlCode.size())
+  if (!netlist.hasAssignment(sync_out_valid))
     llvm_unreachable(std::string("Cannot find sync_out_valid name: " +
                                  sync_out_valid + " for call: " + callName)
                          .c_str());
+  auto sync_in_valid = netlist.getAssignment(sync_out_valid);
+  netlist.removeAssignment(sync_out_valid);
 
-  auto sync_in_valid =
-      vhdlCode[i].substr(vhdlCode[i].find("<=") + 3,
-                         vhdlCode[i].find(";") - vhdlCode[i].find("<=") - 3);
-  vhdlCode[i] = "";
-  i = 0;
-  while (vhdlCode[i].find(" <= " + sync_out_ready) == std::string::npos)
-    i++;
-  auto sync_in_ready = vhdlCode[i].substr(0, vhdlCode[i].find(" <="));
-  vhdlCode[i] = "";
+  auto sync_in_ready = netlist.getAssignedFrom(sync_out_ready);
+  if (sync_in_ready == "")
+    llvm_unreachable(std::string("Cannot find sync_in_ready name: " +
+                                 sync_out_ready + " for call: " + callName)
+                         .c_str());
+  netlist.removeAssignment(sync_in_ready);
 
-  i = 0;
-  while (vhdlCode[i].find(callName + ": ") == std::string::npos)
-    i++;
-  i++;
-  vhdlCode[i] += "\n\tsync_in_ready => " + sync_in_ready +
-                 ",\n\tsync_out_valid => " + sync_out_valid +
-                 ",\n\tsync_in_valid => " + sync_in_valid +
-                 ",\n\tsync_out_ready => " + sync_out_ready + ",\n";
+  auto inst = netlist.getInstance(callName);
+  if (!inst)
+    llvm_unreachable(
+        std::string("Cannot find call " + callName + " in vhdl.\n").c_str());
+  netlist.addPort(inst, "sync_in_ready", sync_in_ready);
+  netlist.addPort(inst, "sync_out_valid", sync_out_valid);
+  netlist.addPort(inst, "sync_in_valid", sync_in_valid);
+  netlist.addPort(inst, "sync_out_ready", sync_out_ready);
 }
 
-static void addSyncConnections(std::vector<std::string> &vhdlCode,
-                               ENode_vec *enode_dag,
+static void addSyncConnections(VHDLNetlist &netlist, ENode_vec *enode_dag,
                                ArrayRef<SharedMemory *> sharedArrays) {
   for (auto enode : *enode_dag) {
     if (!isSSCall(enode))
@@ -1318,11 +1471,11 @@ static void addSyncConnections(std::vector<std::string> &vhdlCode,
     auto callName = getNodeDotNameNew(enode);
     callName = callName.substr(1, callName.rfind("\"") - 1);
 
-    syncCall(callName, branchName, vhdlCode);
+    syncCall(callName, branchName, netlist);
   }
 }
 
-static void updateLoopInterchangerDepths(std::vector<std::string> &vhdlCode) {
+static void updateLoopInterchangerDepths(VHDLNetlist &netlist) {
   auto fileName = "./loop_interchange.tcl";
   std::ifstream ifile(fileName);
   if (!ifile.is_open())
@@ -1336,24 +1489,22 @@ static void updateLoopInterchangerDepths(std::vector<std::string> &vhdlCode) {
   int i = 0;
   for (auto constraint : constraints) {
     auto depth = std::stoi(constraint.substr(constraint.rfind(",") + 1));
-    auto j = 0;
-    while (j < vhdlCode.size() && vhdlCode[j].find("loop_" + std::to_string(i) +
-                                                   ":") == std::string::npos ||
-           vhdlCode[j].find("loop_interchanger") == std::string::npos)
-      j++;
-    if (j == vhdlCode.size()) {
+    auto inst = netlist.getInstance("loop_" + std::to_string(i));
+    if (!inst || inst->entity.find("loop_interchanger") == std::string::npos) {
       llvm::errs() << "loop_" << i << ": \n";
       llvm_unreachable("Cannot find loop_interchanger in vhdl.\n");
     }
     llvm::errs() << "Loop_" << i << " has a depth of " << depth << "\n";
-    vhdlCode[j] = vhdlCode[j].substr(0, vhdlCode[j].rfind(")")) + ", " +
-                  std::to_string(depth) + ")\n";
+    auto &header = netlist.getHeader(inst);
+    header = header.substr(0, header.rfind(")")) + ", " +
+             std::to_string(depth) + ")";
     i++;
   }
 }
 
-static void updateDASSFIFODepth(std::vector<std::string> &vhdlCode) {
-  for (auto &line : vhdlCode)
+static void updateDASSFIFODepth(VHDLNetlist &netlist) {
+  for (auto &inst : netlist.getInstances()) {
+    auto &line = netlist.getHeader(&inst);
     if (line.find("DASSFIFO_") != std::string::npos &&
         line.find("_op(arch)") != std::string::npos) {
 
@@ -1386,6 +1537,7 @@ static void updateDASSFIFODepth(std::vector<std::string> &vhdlCode) {
         line = line.substr(0, line.rfind(")")) + ", " + std::to_string(depth) +
                ")";
     }
+  }
 }
 
 namespace {
@@ -1413,10 +1565,12 @@ bool StaticIslandInsertionPass::runOnModule(Module &M) {
     llvm_unreachable(
         std::string("Cannot find RTL file " + fileName + ".\n").c_str());
 
-  std::vector<std::string> vhdlCode;
-  std::string line;
-  while (std::getline(ifile, line))
-    vhdlCode.push_back(line);
+  VHDLNetlist netlist;
+  if (!netlist.read(ifile, opt_top))
+    llvm_unreachable(
+        std::string("Cannot find top design " + opt_top + " in " + fileName +
+                    ".\n")
+            .c_str());
   ifile.close();
 
   Function *dsFunc;
@@ -1435,19 +1589,18 @@ bool StaticIslandInsertionPass::runOnModule(Module &M) {
     auto sharedArrays = getSharedArrays(dsFunc);
     llvm::errs() << "Found " << sharedArrays.size()
                  << " shared arrays between SS and DS functions.\n";
-    addMemoryArbitrationLogic(vhdlCode, sharedArrays);
+    addMemoryArbitrationLogic(netlist, sharedArrays);
     auto enode_dag = getAnalysis<MyCFGPass>(*dsFunc).enode_dag;
-    addSyncConnections(vhdlCode, enode_dag, sharedArrays);
+    addSyncConnections(netlist, enode_dag, sharedArrays);
   }
 
-  updateLoopInterchangerDepths(vhdlCode);
+  updateLoopInterchangerDepths(netlist);
 
-  updateDASSFIFODepth(vhdlCode);
+  updateDASSFIFODepth(netlist);
 
   std::error_code ec;
   llvm::raw_fd_ostream outfile("./rtl/" + opt_top + "_new.vhd", ec);
-  for (auto &s : vhdlCode)
-    outfile << s << "\n";
+  netlist.write(outfile);
   outfile.close();
   return true;
 }
@@ -0,0 +1,235 @@
+#include "VHDLNetlist.h"
+#include "llvm/Support/ErrorHandling.h"
+
+static std::string trim(const std::string &s) {
+  auto first = s.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  auto last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+static bool startsWith(const std::string &s, const std::string &prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool VHDLNetlist::read(std::istream &in, const std::string &top) {
+  std::string line;
+  while (std::getline(in, line))
+    lines.push_back(line);
+
+  auto size = lines.size();
+  unsigned i = 0;
+  while (i < size &&
+         lines[i].find("entity " + top + " is") == std::string::npos)
+    i++;
+  if (i == size)
+    return false;
+  entityPorts = i + 1;
+
+  while (i < size && lines[i].find("architecture behavioral of " + top +
+                                   " is") == std::string::npos)
+    i++;
+  if (i == size)
+    return false;
+  archDecls = i;
+
+  while (i < size && trim(lines[i]) != "begin")
+    i++;
+  if (i == size)
+    return false;
+  archBegin = i;
+
+  for (i++; i < size; i++) {
+    auto &s = lines[i];
+    if (startsWith(s, "end behavioral"))
+      break;
+
+    auto pos = s.find(": entity work.");
+    if (pos != std::string::npos) {
+      instances.emplace_back();
+      auto &inst = instances.back();
+      inst.name = trim(s.substr(0, pos));
+      inst.header = i;
+      auto entity = s.substr(pos + 14);
+      inst.entity = entity.substr(0, entity.find_first_of("( "));
+      instanceIdx.emplace(inst.name, &inst);
+      entityIdx.emplace(inst.entity, &inst);
+
+      // Skip "port map (", then index "formal => actual" up to ");"
+      for (i += 2; i < size && !startsWith(trim(lines[i]), ")"); i++) {
+        auto arrow = lines[i].find(" => ");
+        if (arrow != std::string::npos)
+          inst.ports.emplace(trim(lines[i].substr(0, arrow)), i);
+      }
+      continue;
+    }
+
+    pos = s.find(" <= ");
+    auto end = s.rfind(';');
+    if (pos != std::string::npos && end != std::string::npos && end > pos) {
+      targetIdx.emplace(trim(s.substr(0, pos)), i);
+      sourceIdx.emplace(trim(s.substr(pos + 4, end - pos - 4)), i);
+    }
+  }
+  if (i == size)
+    return false;
+  archEnd = i;
+  return true;
+}
+
+void VHDLNetlist::write(llvm::raw_ostream &out) const {
+  auto inst = instances.begin();
+  for (unsigned i = 0; i < lines.size(); i++) {
+    if (i == archEnd)
+      for (auto &s : newInstances)
+        out << s << "\n";
+
+    auto after = newPortsAfter.find(i);
+    if (after == newPortsAfter.end())
+      out << lines[i] << "\n";
+    else {
+      // The association may be the last of the port map
+      bool isLast = (trim(lines[i]).back() != ',');
+      out << lines[i] << (isLast ? ",\n" : "\n");
+      auto &ports = after->second;
+      for (unsigned k = 0; k < ports.size(); k++)
+        out << "\t" << ports[k].first << " => " << ports[k].second
+            << ((isLast && k + 1 == ports.size()) ? "\n" : ",\n");
+    }
+
+    if (i == entityPorts)
+      for (auto &s : newEntityPorts)
+        out << "\t" << s << ";\n";
+    else if (i == archDecls)
+      for (auto &s : newSignals)
+        out << "\t" << s << ";\n";
+    else if (i == archBegin)
+      for (auto &s : newStatements)
+        out << "\t" << s << ";\n";
+    else if (inst != instances.end() && i == inst->header + 1) {
+      // Associations of whole ports are order independent, so the new ones
+      // lead the port map and keep the trailing comma rule of the original
+      // list intact
+      for (auto &p : inst->newPorts)
+        out << "\t" << p.first << " => " << p.second << ",\n";
+      inst++;
+    }
+  }
+}
+
+VHDLNetlist::Instance *VHDLNetlist::getInstance(const std::string &name) {
+  auto it = instanceIdx.find(name);
+  return (it == instanceIdx.end()) ? nullptr : it->second;
+}
+
+VHDLNetlist::Instance *VHDLNetlist::getInstanceOf(const std::string &entity) {
+  auto it = entityIdx.find(entity);
+  return (it == entityIdx.end()) ? nullptr : it->second;
+}
+
+bool VHDLNetlist::hasPort(Instance *inst, const std::string &formal) {
+  return inst->ports.count(formal);
+}
+
+std::string VHDLNetlist::getPort(Instance *inst, const std::string &formal) {
+  auto it = inst->ports.find(formal);
+  if (it == inst->ports.end())
+    return "";
+  auto &s = lines[it->second];
+  auto actual = trim(s.substr(s.find(" => ") + 4));
+  if (!actual.empty() && actual.back() == ',')
+    actual.pop_back();
+  return actual;
+}
+
+void VHDLNetlist::setPort(Instance *inst, const std::string &formal,
+                          const std::string &actual) {
+  auto it = inst->ports.find(formal);
+  if (it == inst->ports.end())
+    llvm::report_fatal_error("Cannot find port " + formal + " of " +
+                             inst->name + " in vhdl.");
+  auto &s = lines[it->second];
+  auto comma = (trim(s).back() == ',') ? "," : "";
+  s = "\t" + formal + " => " + actual + comma;
+}
+
+void VHDLNetlist::addPort(Instance *inst, const std::string &formal,
+                          const std::string &actual) {
+  inst->newPorts.push_back({formal, actual});
+}
+
+void VHDLNetlist::addPortAfter(Instance *inst, const std::string &after,
+                               const std::string &formal,
+                               const std::string &actual) {
+  auto it = inst->ports.find(after);
+  if (it == inst->ports.end())
+    addPort(inst, formal, actual);
+  else
+    newPortsAfter[it->second].push_back({formal, actual});
+}
+
+bool VHDLNetlist::hasAssignment(const std::string &target) {
+  return targetIdx.count(target);
+}
+
+std::string VHDLNetlist::getAssignment(const std::string &target) {
+  auto it = targetIdx.find(target);
+  if (it == targetIdx.end())
+    return "";
+  auto &s = lines[it->second];
+  auto pos = s.find(" <= ");
+  return trim(s.substr(pos + 4, s.rfind(';') - pos - 4));
+}
+
+std::string VHDLNetlist::getAssignedFrom(const std::string &source) {
+  auto it = sourceIdx.find(source);
+  if (it == sourceIdx.end())
+    return "";
+  auto &s = lines[it->second];
+  return trim(s.substr(0, s.find(" <= ")));
+}
+
+// Only the first assignment reading a source is indexed
+void VHDLNetlist::dropSource(const std::string &target, unsigned line) {
+  auto it = sourceIdx.find(getAssignment(target));
+  if (it != sourceIdx.end() && it->second == line)
+    sourceIdx.erase(it);
+}
+
+void VHDLNetlist::setAssignment(const std::string &target,
+                                const std::string &source) {
+  auto it = targetIdx.find(target);
+  if (it == targetIdx.end()) {
+    addStatement(target + " <= " + source);
+    return;
+  }
+  dropSource(target, it->second);
+  lines[it->second] = "\t" + target + " <= " + source + ";";
+  sourceIdx.emplace(source, it->second);
+}
+
+void VHDLNetlist::removeAssignment(const std::string &target) {
+  auto it = targetIdx.find(target);
+  if (it == targetIdx.end())
+    return;
+  dropSource(target, it->second);
+  lines[it->second] = "";
+  targetIdx.erase(it);
+}
+
+void VHDLNetlist::addEntityPort(const std::string &decl) {
+  newEntityPorts.push_back(decl);
+}
+
+void VHDLNetlist::addSignal(const std::string &decl) {
+  newSignals.push_back(decl);
+}
+
+void VHDLNetlist::addStatement(const std::string &stmt) {
+  newStatements.push_back(stmt);
+}
+
+void VHDLNetlist::addInstance(const std::string &text) {
+  newInstances.push_back(text);
+}
@@ -17,6 +17,7 @@
 #include <fstream>
 #include <regex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace llvm;
@@ -29,6 +30,22 @@ struct pipelineState {
   std::vector<std::string> stmts;
 };
 
+// An operation of the schedule report, e.g. in state ST_3:
+//   "%a_read = read i32 @_ssdm_op_Read.ap_auto.i32, i32 %a"
+struct scheduleOp {
+  int state = -1;
+  std::string def;     // Name assigned by the op, e.g. a_read
+  std::string lastVar; // Last operand, e.g. a
+  bool isRead = false;
+  bool isWrite = false;
+};
+
+// An op that names an SSA value, either as operand or as result
+struct scheduleRef {
+  int op;     // Index in the op list, which is sorted by state
+  bool isDef; // The op assigns the value
+};
+
 enum PortType { INPUT, OUTPUT, BRAM, UNKNOWN };
 
 class PortInfo {
@@ -132,6 +149,16 @@ private:
   llvm::DenseMap<int, PortInfo *> portInfo;
   bool hasDummyIn = false;
 
+  // Def-use index of the schedule: ops in state order, the first op of each
+  // state, and the ops naming each SSA value
+  std::vector<scheduleOp> ops;
+  std::vector<int> stateOps;
+  std::unordered_map<std::string, std::vector<scheduleRef>> refs;
+
+  void indexSchedule();
+  const std::vector<scheduleRef> &getRefs(const std::string &name);
+  std::string getUse(const std::string &name, bool isRead);
+  int getOffset(const std::string &name, bool isRead);
   void getIdleStatesAndFirstOpLatency(const std::string &name, const int offset,
                                       int *firstOpLatency, int *idleStates);
 };
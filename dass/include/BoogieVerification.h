@@ -8,6 +8,7 @@
 
 #include <fstream>
 #include <regex>
+#include <sstream>
 
 using namespace llvm;
 
@@ -46,17 +47,20 @@ public:
   void analyzeLoop(std::string loopName);
   void generateFunctionBody(bool isLoopAnalysis);
 
-  void open(std::string file) { bpl.open(file, std::fstream::out); }
-  void close() { bpl.close(); }
-  std::fstream &getBoogieStream() { return bpl; }
+  std::stringstream &getBoogieStream() { return bpl; }
   Function *getFunction() { return F; }
   void setFunction(Function *func) { F = func; }
 
   void generateMainForLoopInterchange(int distance);
+  // Only main depends on the interchange depth, so the rest of the program is
+  // generated once for the analyzed loop and shared by all the depths
+  void generateLoopAnalysis();
+  void generateLoopInterchangeCheck(std::string file, int distance);
 
 private:
   Function *F;
-  std::fstream bpl;
+  std::stringstream bpl;
+  std::string loopAnalysis;
   std::string BW = "32";
   std::vector<BoogiePhiNode *> phis;
   std::vector<BoogieInvariance *> invariances;
@@ -0,0 +1,68 @@
+#pragma once
+#include "llvm/Support/raw_ostream.h"
+
+#include <deque>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Indexed model of a dot graph exported by the Dynamatic buffering tool. The
+// source lines are kept verbatim, while the node declarations, the edges by
+// destination port and the basic block clusters are indexed by name in a
+// single pass when the file is read. Edits are lookups into these indices;
+// edited lines are regenerated in place and new lines are attached after
+// their anchor line, so write() serializes the graph once.
+class DotGraph {
+
+public:
+  struct Edge {
+    std::string indent;
+    std::string src, dst; // Node names as written, possibly quoted
+    std::string attrs;    // Everything after the destination
+    unsigned line;
+    bool removed = false;
+  };
+
+  void read(std::istream &in);
+  void write(llvm::raw_ostream &out) const;
+
+  std::deque<Edge> &getEdges() { return edges; }
+  // Edge into the given port of a node, nullptr if none
+  Edge *getInEdge(const std::string &dst, const std::string &port);
+  // Edges leaving a node, in file order
+  std::vector<Edge *> getOutEdges(const std::string &src);
+  static std::string getName(const std::string &node);
+
+  // Insert node between the source and the destination of the edge. The
+  // edge now ends at in1 of node, which drives the original port from out1.
+  void insertNode(Edge *edge, const std::string &node);
+  // Remove a node with a single input and a single output. The edge into the
+  // node is redirected to the port its output edge drove.
+  void bypassNode(const std::string &node);
+
+  // Node declarations
+  std::vector<std::string> getNodes() const;
+  bool hasNode(const std::string &name);
+  std::string getNodeAttr(const std::string &name, const std::string &attr);
+  // Slots of a buffer, also shown in its label as "[<slots>t]"
+  void setSlots(const std::string &name, int slots);
+  // Declare a node in the cluster of the given block, false if not found
+  bool addNode(int bb, const std::string &name, const std::string &decl);
+
+private:
+  unsigned addLine(unsigned anchor, const std::string &text);
+  void updateEdge(Edge *edge);
+
+  std::vector<std::string> lines;
+  // Lines added after each line, emitted in insertion order
+  std::unordered_map<unsigned, std::vector<unsigned>> following;
+  std::vector<bool> isFollowing;
+  std::vector<bool> isRemoved;
+
+  std::deque<Edge> edges;
+  std::unordered_map<std::string, Edge *> inEdgeIdx; // "dst:port" -> edge
+  std::unordered_multimap<std::string, Edge *> outEdgeIdx;
+  std::unordered_map<std::string, unsigned> nodeIdx;
+  std::unordered_map<int, unsigned> blockIdx; // label = "block<N>"
+};
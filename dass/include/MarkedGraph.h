@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+
+// Marked graph of a dataflow circuit, where each edge carries the latency of
+// its source and the number of tokens initially on it. The throughput of the
+// circuit is bounded by its critical cycle, i.e. the cycle with the maximum
+// ratio of latency over tokens. Every cycle must hold at least one token.
+class MarkedGraph {
+
+public:
+  explicit MarkedGraph(unsigned numNodes) : succs(numNodes) {}
+
+  void addEdge(unsigned src, unsigned dst, double latency, unsigned tokens);
+
+  // Maximum cycle ratio computed with Howard's policy iteration, 0 if the
+  // graph is acyclic and infinity if a cycle holds no token
+  double getMaxCycleRatio() const;
+
+private:
+  struct Edge {
+    unsigned dst;
+    double latency;
+    unsigned tokens;
+  };
+
+  std::vector<std::vector<Edge>> succs;
+};
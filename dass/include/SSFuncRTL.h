@@ -0,0 +1,50 @@
+#pragma once
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <vector>
+
+// Post-processing of the RTL exported by Vitis HLS for a SS function. An input
+// with an offset is registered by a chain of "<port>_read_reg_<N>" shift
+// registers, which the offset constraints in the DS circuit already account
+// for, so the last register of the chain is replaced by the port. The clock
+// enable is also removed from the conditions of the memory, output and done
+// strobes. Both the Verilog and the VHDL exported by Vitis HLS 2020.2 are
+// supported.
+class SSFuncRTL {
+
+public:
+  // Port of the function in ss_offset.tcl, exported by
+  // AutopilotParser::exportOffsets as "name,idx,isIn,offset,idleSt,
+  // firstOpLatency,depth,"
+  struct OffsetPort {
+    std::string name;
+    int idx, isIn, offset, idleSt, firstOpLatency, depth;
+  };
+
+  SSFuncRTL(const std::string &top, bool isVHDL) : top(top), isVHDL(isVHDL) {}
+
+  // Offsets of top in ss_offset.tcl, false if top is not found
+  bool readOffsets(const std::string &text);
+  // Returns false if the module or the entity of top is not found
+  bool read(const std::string &text);
+  std::string write() const;
+
+  // Removes the shift registers of the inputs with a FIFO depth. The
+  // mismatches with the expected depths are reported to log.
+  void removeShiftRegs(llvm::raw_ostream &log);
+  void removeClockEnables();
+
+private:
+  // Line assigning the register after signal in the chain and the register,
+  // or -1 and signal at the end of the chain
+  std::pair<int, std::string> getAssignedSignal(const std::string &signal);
+  void rewriteInput(const OffsetPort &port, llvm::raw_ostream &log);
+
+  std::string top;
+  bool isVHDL;
+  std::vector<OffsetPort> ports;
+  std::vector<std::string> lines;
+  // Lines of the module or of the entity and architecture of top
+  unsigned begin, end;
+};
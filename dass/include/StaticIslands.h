@@ -37,4 +37,8 @@ bool arePerfectlyNested(Loop &OuterLoop, Loop &InnerLoop, ScalarEvolution &SE);
 Value *getConstantBoundedIndVar(Loop *loop, ScalarEvolution &SE);
 
 // Get all the innermost loops
-std::vector<Loop *> extractInnermostLoops(LoopInfo &LI);
\ No newline at end of file
+std::vector<Loop *> extractInnermostLoops(LoopInfo &LI);
+
+// Latency in cycles of an instruction in the dataflow circuit on the device
+// selected by -target
+unsigned getOperatorLatency(Instruction *inst);
@@ -0,0 +1,85 @@
+#pragma once
+#include "llvm/Support/raw_ostream.h"
+
+#include <deque>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Indexed model of the top-level netlist generated by dot2vhdl. The source
+// lines are kept verbatim, while the top entity ports, the architecture
+// sections, the component instances with their port maps and the concurrent
+// assignments are indexed by name in a single pass when the file is read.
+// Rewrites are lookups into these indices; new declarations, statements and
+// port associations are attached to their section and emitted by write().
+class VHDLNetlist {
+
+public:
+  struct Instance {
+    std::string name;   // Instance label, e.g. MC_x
+    std::string entity; // Entity name without library, e.g. MemCont
+    unsigned header;    // Line of "<name>: entity work.<entity>..."
+    std::unordered_map<std::string, unsigned> ports; // formal -> line
+    std::vector<std::pair<std::string, std::string>> newPorts;
+  };
+
+  // Returns false if the entity or the architecture of top is not found
+  bool read(std::istream &in, const std::string &top);
+  void write(llvm::raw_ostream &out) const;
+
+  std::deque<Instance> &getInstances() { return instances; }
+  Instance *getInstance(const std::string &name);
+  // First instance of the given entity
+  Instance *getInstanceOf(const std::string &entity);
+  std::string &getHeader(Instance *inst) { return lines[inst->header]; }
+
+  // Port map of an instance
+  bool hasPort(Instance *inst, const std::string &formal);
+  std::string getPort(Instance *inst, const std::string &formal);
+  void setPort(Instance *inst, const std::string &formal,
+               const std::string &actual);
+  void addPort(Instance *inst, const std::string &formal,
+               const std::string &actual);
+  // Associations of the subelements of an array port must be contiguous, so
+  // the new one follows the given association, or leads the port map if the
+  // instance has no such formal
+  void addPortAfter(Instance *inst, const std::string &after,
+                    const std::string &formal, const std::string &actual);
+
+  // Concurrent assignments "target <= source;"
+  bool hasAssignment(const std::string &target);
+  std::string getAssignment(const std::string &target);
+  // Target of the first assignment reading exactly the given source
+  std::string getAssignedFrom(const std::string &source);
+  void setAssignment(const std::string &target, const std::string &source);
+  void removeAssignment(const std::string &target);
+
+  void addEntityPort(const std::string &decl);
+  void addSignal(const std::string &decl);
+  void addStatement(const std::string &stmt);
+  void addInstance(const std::string &text);
+
+private:
+  void dropSource(const std::string &target, unsigned line);
+
+  std::vector<std::string> lines;
+  std::deque<Instance> instances;
+  std::unordered_map<std::string, Instance *> instanceIdx;
+  std::unordered_map<std::string, Instance *> entityIdx;
+  std::unordered_map<std::string, unsigned> targetIdx;
+  std::unordered_map<std::string, unsigned> sourceIdx;
+
+  // Anchors: "port (" of the top entity, "architecture ... is", "begin" and
+  // "end behavioral;"
+  unsigned entityPorts, archDecls, archBegin, archEnd;
+
+  std::vector<std::string> newEntityPorts;
+  std::vector<std::string> newSignals;
+  std::vector<std::string> newStatements;
+  std::vector<std::string> newInstances;
+  // Port map line -> associations following it
+  std::unordered_map<unsigned,
+                     std::vector<std::pair<std::string, std::string>>>
+      newPortsAfter;
+};
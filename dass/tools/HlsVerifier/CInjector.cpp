@@ -23,12 +23,12 @@ namespace hls_verify {
     CInjector::CInjector(const VerificationContext& ctx) : ctx(ctx) {
         
         const CFunction& func = ctx.get_c_fuv();
-        // add stdio.h include and get preprocessor output
+        // add stdio.h include and the file IO runtime, and get preprocessor output
         ifstream cFuvSrcFileIn(ctx.get_c_fuv_path());
         string cFuv((istreambuf_iterator<char>(cFuvSrcFileIn)), istreambuf_iterator<char>());
         cFuvSrcFileIn.close();
         ofstream cFuvSrcFileOut(ctx.get_c_fuv_path() + ".tmp.c");
-        cFuvSrcFileOut << "#include <stdio.h>" << endl << cFuv;
+        cFuvSrcFileOut << "#include <stdio.h>" << endl << endl << get_runtime_declarations(func) << cFuv;
         cFuvSrcFileOut.close();
         
         cFuv = CAnalyser::get_preproc_output(ctx.get_c_fuv_path() + ".tmp.c");
@@ -83,22 +83,50 @@ namespace hls_verify {
         injectedFuvSrc = out.str();
     }
     
-    string CInjector::get_variable_declarations(const CFunction& func) {
+    // Each vector file is opened once with a large buffer and stays open until
+    // the testbench exits, instead of being reopened on every call. Values are
+    // printed with a small hex writer, in the same format as "0x%08llx".
+    string CInjector::get_runtime_declarations(const CFunction& func) {
         stringstream out;
+        out << "static FILE * hlsv_open(const char * path) {" << endl;
+        out << "\tFILE * f = fopen(path, \"a\");" << endl;
+        out << "\tsetvbuf(f, NULL, _IOFBF, 1 << 20);" << endl;
+        out << "\treturn f;" << endl;
+        out << "}" << endl << endl;
+        out << "static void hlsv_write(FILE * f, unsigned long long v) {" << endl;
+        out << "\tchar buf[20];" << endl;
+        out << "\tint i = sizeof(buf);" << endl;
+        out << "\tbuf[--i] = '\\n';" << endl;
+        out << "\tdo {" << endl;
+        out << "\t\tbuf[--i] = \"0123456789abcdef\"[v & 15];" << endl;
+        out << "\t\tv >>= 4;" << endl;
+        out << "\t} while (v || i > (int)sizeof(buf) - 9);" << endl;
+        out << "\tbuf[--i] = 'x';" << endl;
+        out << "\tbuf[--i] = '0';" << endl;
+        out << "\tfwrite(buf + i, 1, sizeof(buf) - i, f);" << endl;
+        out << "}" << endl << endl;
         if (func.return_val.actual_type != "void") {
-            out << "\t" << func.return_val.immeadiate_type + " hlsv_return;" << endl;
-            out << "\tFILE * hlsv_of_return;" << endl;
+            out << "static FILE * hlsv_of_return = NULL;" << endl;
         }
         for (int i = 0; i < func.params.size(); i++) {
             if (func.params[i].is_input) {
-                out << "\tFILE * hlsv_if_" << func.params[i].parameter_name << ";" << endl;
+                out << "static FILE * hlsv_if_" << func.params[i].parameter_name << " = NULL;" << endl;
             }
         }
         for (int i = 0; i < func.params.size(); i++) {
             if (func.params[i].is_output) {
-                out << "\tFILE * hlsv_of_" << func.params[i].parameter_name << ";" << endl;
+                out << "static FILE * hlsv_of_" << func.params[i].parameter_name << " = NULL;" << endl;
             }
         }
+        out << endl;
+        return out.str();
+    }
+    
+    string CInjector::get_variable_declarations(const CFunction& func) {
+        stringstream out;
+        if (func.return_val.actual_type != "void") {
+            out << "\t" << func.return_val.immeadiate_type + " hlsv_return;" << endl;
+        }
         out << endl << "\tint hlsv_i = 0;" << endl;
         
         int max_dim = 0;
@@ -134,20 +162,20 @@ namespace hls_verify {
         // TODO: edit the following line for non integer types
         if (param.is_float_type) {
             if (param.dt_width == 32) {
-                out << "\tfprintf(" << file_name_prefix << param.parameter_name << ", \"0x%08x\\n\", *((unsigned int *)&" << param.parameter_name;
+                out << "\thlsv_write(" << file_name_prefix << param.parameter_name << ", *((unsigned int *)&" << param.parameter_name;
                 for (int d = 0; d < param.dims.size(); d++) {
                     out << "[hlsv_i" << to_string(d) << "]";
                 }
                 out << "));" << endl;
             } else {
-                out << "\tfprintf(" << file_name_prefix << param.parameter_name << ", \"0x%08llx\\n\", *((unsigned long long *)&" << param.parameter_name;
+                out << "\thlsv_write(" << file_name_prefix << param.parameter_name << ", *((unsigned long long *)&" << param.parameter_name;
                 for (int d = 0; d < param.dims.size(); d++) {
                     out << "[hlsv_i" << to_string(d) << "]";
                 }
                 out << "));" << endl;
             }
         } else {
-            out << "\t\tfprintf(" << file_name_prefix << param.parameter_name << ", \"0x%08llx\\n\", (long long)" << param.parameter_name;
+            out << "\t\thlsv_write(" << file_name_prefix << param.parameter_name << ", (long long)" << param.parameter_name;
             for (int d = 0; d < param.dims.size(); d++) {
                 out << "[hlsv_i" << to_string(d) << "]";
             }
@@ -161,25 +189,25 @@ namespace hls_verify {
     
     string CInjector::get_file_io_code_for_input_param(const CFunctionParameter& param) {
         stringstream out;
-        out << "\thlsv_if_" << param.parameter_name << " = fopen(\"" << ctx.get_input_vector_path(param) << "\", \"a\");" << endl;
+        out << "\tif (!hlsv_if_" << param.parameter_name << ") hlsv_if_" << param.parameter_name << " = hlsv_open(\"" << ctx.get_input_vector_path(param) << "\");" << endl;
         out << "\tfprintf(hlsv_if_" << param.parameter_name << ", \"[[transaction]] %d\\n\", hlsv_transaction_id);" << endl;
         if (param.is_pointer) {
             out << array_print_code(param, "hlsv_if_");
         } else {
             if (param.is_float_type) {
                 if (param.dt_width == 32) {
-                    out << "\tfprintf(hlsv_if_" << param.parameter_name << ", \"0x%08x\\n\",  *((unsigned int *)&" << param.parameter_name << "));" << endl;
+                    out << "\thlsv_write(hlsv_if_" << param.parameter_name << ", *((unsigned int *)&" << param.parameter_name << "));" << endl;
                     
                 } else {
-                    out << "\tfprintf(hlsv_if_" << param.parameter_name << ", \"0x%08llx\\n\",  *((unsigned long long *)&" << param.parameter_name << "));" << endl;
+                    out << "\thlsv_write(hlsv_if_" << param.parameter_name << ", *((unsigned long long *)&" << param.parameter_name << "));" << endl;
                     
                 }
             } else {
-                out << "\tfprintf(hlsv_if_" << param.parameter_name << ", \"0x%08llx\\n\", (long long)" << param.parameter_name << ");" << endl;
+                out << "\thlsv_write(hlsv_if_" << param.parameter_name << ", (long long)" << param.parameter_name << ");" << endl;
             }
         }
         out << "\tfprintf(hlsv_if_" << param.parameter_name << ", \"[[/transaction]]\\n\");" << endl;
-        out << "\tfclose(hlsv_if_" << param.parameter_name << ");" << endl << endl;
+        out << endl;
         return out.str();
     }
     
@@ -198,25 +226,25 @@ namespace hls_verify {
     
     string CInjector::get_file_io_code_for_output_param(const CFunctionParameter& param) {
         stringstream out;
-        out << "\t\thlsv_of_" << param.parameter_name << " = fopen(\"" << ctx.get_c_out_path(param) << "\", \"a\");" << endl;
+        out << "\t\tif (!hlsv_of_" << param.parameter_name << ") hlsv_of_" << param.parameter_name << " = hlsv_open(\"" << ctx.get_c_out_path(param) << "\");" << endl;
         out << "\t\tfprintf(hlsv_of_" << param.parameter_name << ", \"[[transaction]] %d\\n\", hlsv_transaction_id);" << endl;
         if (param.is_pointer) {
             out << array_print_code(param, "hlsv_of_");
         } else {
             if (param.is_float_type) {
                 if (param.dt_width == 32) {
-                    out << "\tfprintf(hlsv_of_" << param.parameter_name << ", \"0x%08x\\n\",  *((unsigned int *)&" << param.parameter_name << "));" << endl;
+                    out << "\thlsv_write(hlsv_of_" << param.parameter_name << ", *((unsigned int *)&" << param.parameter_name << "));" << endl;
                     
                 } else {
-                    out << "\tfprintf(hlsv_of_" << param.parameter_name << ", \"0x%08llx\\n\",  *((unsigned long long *)&" << param.parameter_name << "));" << endl;
+                    out << "\thlsv_write(hlsv_of_" << param.parameter_name << ", *((unsigned long long *)&" << param.parameter_name << "));" << endl;
                     
                 }
             } else {
-                out << "\tfprintf(hlsv_of_" << param.parameter_name << ", \"0x%08llx\\n\",  (long long)" << param.parameter_name << ");" << endl;
+                out << "\thlsv_write(hlsv_of_" << param.parameter_name << ", (long long)" << param.parameter_name << ");" << endl;
             }
         }
         out << "\t\tfprintf(hlsv_of_" << param.parameter_name << ", \"[[/transaction]]\\n\");" << endl;
-        out << "\t\tfclose(hlsv_of_" << param.parameter_name << ");" << endl << endl;
+        out << endl;
         return out.str();
     }
     
@@ -230,21 +258,21 @@ namespace hls_verify {
         
         out << "\t\thlsv_return = " << actualReturnValue << ";" << endl;
         
-        out << "\t\thlsv_of_return = fopen(\"" << ctx.get_c_out_path(param) << "\", \"a\");" << endl;
+        out << "\t\tif (!hlsv_of_return) hlsv_of_return = hlsv_open(\"" << ctx.get_c_out_path(param) << "\");" << endl;
         out << "\t\tfprintf(hlsv_of_return, \"[[transaction]] %d\\n\", hlsv_transaction_id);" << endl;
         if (param.is_float_type) {
             if (param.dt_width == 32) {
-                out << "\t\tfprintf(hlsv_of_return, \"0x%08x\\n\",  *((unsigned int *)&hlsv_return));" << endl;
+                out << "\t\thlsv_write(hlsv_of_return, *((unsigned int *)&hlsv_return));" << endl;
                 
             } else {
-                out << "\t\tfprintf(hlsv_of_return, \"0x%08llx\\n\",  *((unsigned long long*)&hlsv_return));" << endl;
+                out << "\t\thlsv_write(hlsv_of_return, *((unsigned long long*)&hlsv_return));" << endl;
                 
             }
         } else {
-            out << "\t\tfprintf(hlsv_of_return, \"0x%08llx\\n\", (long long)hlsv_return);" << endl;
+            out << "\t\thlsv_write(hlsv_of_return, (long long)hlsv_return);" << endl;
         }
         out << "\t\tfprintf(hlsv_of_return, \"[[/transaction]]\\n\");" << endl;
-        out << "\t\tfclose(hlsv_of_return);" << endl << endl;
+        out << endl;
         
         out << "\t\treturn hlsv_return;" << endl;
         return out.str();
@@ -23,6 +23,7 @@ namespace hls_verify {
         string get_file_io_code_for_return_value(const CFunctionParameter& param, string actualReturnValue);
         string get_file_io_code_for_input(const CFunction& func);
         string get_file_io_code_for_output(const CFunction& func, string actualReturnValue);
+        string get_runtime_declarations(const CFunction & func);
         string get_variable_declarations(const CFunction & func);
     };
 }
@@ -9,6 +9,10 @@ namespace hls_verify {
         ss << "Usage 1:\n\thlsverifier cver <c_testbench_path> <c_duv_path> <c_fuv_name>" << endl;
         ss << "Usage 2:\n\thlsverifier vver <c_testbench_path> <vhdl_entitiy_name>" << endl;
         ss << "Usage 3:\n\thlsverifier cover <c_testbench_path> <c_duv_path> <vhdl_entitiy_name>" << endl << endl;
+        ss << "Options (vver and cover):\n"
+                "\t-aw32\t\tuse 32-bit memory addresses\n"
+                "\t-sim=<name>\tsimulator: xsim (default), modelsim or ghdl\n"
+                "\t-j<N>\t\tsplit the transactions into N simulations run in parallel" << endl << endl;
         ss << "Note:\n\tAll C source files should be in the same subdirectory." << endl << endl;
         ss << "\tAssumes hlsverifier is run from a subdirectory (called HLS_VERIFY), which \n"
                 "\tis in the same level as the subdirectories for C sources (C_SRC) and the \n"
@@ -23,11 +27,11 @@ namespace hls_verify {
     }
 
     string get_vhdl_verification_help_message() {
-        return "Usage:\n\thlsverifier vver <c_testbench_path> <vhdl_entitiy_name>";
+        return "Usage:\n\thlsverifier vver [-aw32] [-sim=xsim|modelsim|ghdl] [-j<N>] <c_testbench_path> <vhdl_entitiy_name>";
     }
 
     string get_co_verification_help_message() {
-        return "Usage:\n\thlsverifier cover <c_testbench_path> <c_duv_path> <vhdl_entitiy_name>";
+        return "Usage:\n\thlsverifier cover [-aw32] [-sim=xsim|modelsim|ghdl] [-j<N>] <c_testbench_path> <c_duv_path> <vhdl_entitiy_name>";
     }
 
 }
\ No newline at end of file
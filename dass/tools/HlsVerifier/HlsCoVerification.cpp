@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <iostream>
 
 #include "Help.h"
@@ -18,6 +19,8 @@ namespace hls_verify {
         }
         
         bool use_addr_width_32 = false;
+        int jobs = 1;
+        string simulator = "xsim";
         
         vector<string> temp;
         
@@ -25,7 +28,11 @@ namespace hls_verify {
             if(arg.size() > 0 && arg[0] == '-'){
                 if(arg == "-aw32"){
                     use_addr_width_32 = true;
-                } 
+                } else if(arg.substr(0, 2) == "-j"){
+                    jobs = atoi(arg.substr(2).c_str());
+                } else if(arg.substr(0, 5) == "-sim="){
+                    simulator = arg.substr(5);
+                }
             } else{
                 temp.push_back(arg);
             }
@@ -48,6 +55,8 @@ namespace hls_verify {
         try {
             VerificationContext ctx(cTbPath, cDuvPath, c_fuv_function_name, vhdl_duv_entity_name, other_c_paths);
             ctx.use_addr_width_32 = use_addr_width_32;
+            ctx.jobs = jobs;
+            ctx.simulator = simulator;
             execute_c_testbench(ctx);
             execute_vhdl_testbench(ctx);
             bool value = compare_c_and_vhdl_outputs(ctx);
@@ -1,5 +1,9 @@
+#include <climits>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <thread>
+#include <unistd.h>
 
 #include "Help.h"
 #include "HlsLogging.h"
@@ -7,8 +11,6 @@
 #include "HlsVhdlVerification.h"
 #include "Utilities.h"
 
-#define XSIM
-
 namespace hls_verify {
 const string LOG_TAG = "VVER";
 
@@ -20,6 +22,8 @@ bool run_vhdl_verification(vector<string> args) {
   }
 
   bool use_addr_width_32 = false;
+  int jobs = 1;
+  string simulator = "xsim";
 
   vector<string> temp;
 
@@ -27,6 +31,10 @@ bool run_vhdl_verification(vector<string> args) {
     if (arg.size() > 0 && arg[0] == '-') {
       if (arg == "-aw32") {
         use_addr_width_32 = true;
+      } else if (arg.substr(0, 2) == "-j") {
+        jobs = atoi(arg.substr(2).c_str());
+      } else if (arg.substr(0, 5) == "-sim=") {
+        simulator = arg.substr(5);
       }
     } else {
       temp.push_back(arg);
@@ -46,6 +54,8 @@ bool run_vhdl_verification(vector<string> args) {
     VerificationContext ctx(c_tb_path, "", c_fuv_function_name,
                             vhdl_duv_entity_name, other_c_paths);
     ctx.use_addr_width_32 = use_addr_width_32;
+    ctx.jobs = jobs;
+    ctx.simulator = simulator;
     execute_vhdl_testbench(ctx);
     check_vhdl_testbench_outputs(ctx);
     return true;
@@ -131,20 +141,32 @@ void generate_xsim_scripts(const VerificationContext &ctx) {
   sh.close();
 }
 
-void check_vhdl_testbench_outputs(const VerificationContext &ctx) {
-  const vector<CFunctionParameter> &output_params = ctx.get_fuv_output_params();
-  cout << "\n--- Comparison Results ---\n" << endl;
-  for (auto it = output_params.begin(); it != output_params.end(); it++) {
-    bool result =
-        compare_files(ctx.get_ref_out_path(*it), ctx.get_vhdl_out_path(*it),
-                      ctx.get_token_comparator(*it));
-    cout << "Comparison of [" + it->parameter_name + "] : "
-         << (result ? "Pass" : "Fail") << endl;
-  }
-  cout << "\n--------------------------\n" << endl;
+void generate_ghdl_scripts(const VerificationContext &ctx) {
+  vector<string> filelist_vhdl =
+      get_list_of_files_in_directory(ctx.get_vhdl_src_dir(), ".vhd");
+  vector<string> filelist_verilog =
+      get_list_of_files_in_directory(ctx.get_vhdl_src_dir(), ".v");
+  if (!filelist_verilog.empty())
+    log_err(LOG_TAG, "Verilog sources are not supported by GHDL and are "
+                     "not simulated.");
+
+  string options = "--std=08 -frelaxed -fsynopsys --workdir=work";
+  ofstream sh("run_ghdl.sh");
+  sh << "mkdir -p work\n";
+  sh << "ghdl -i " << options;
+  for (auto it = filelist_vhdl.begin(); it != filelist_vhdl.end(); it++)
+    sh << " " << ctx.get_vhdl_src_dir() << "/" << *it;
+  sh << "\n";
+  sh << "ghdl -m " << options << " " << ctx.get_vhdl_duv_entity_name()
+     << "_tb\n";
+  sh << "ghdl -r " << options << " " << ctx.get_vhdl_duv_entity_name()
+     << "_tb\n";
+  sh.close();
 }
 
-void execute_vhdl_testbench(const VerificationContext &ctx) {
+// Generates the testbench, the supplementary files and the simulator script
+// in the current HLS_VERIFY directory, and returns the simulation command
+static string prepare_vhdl_testbench(const VerificationContext &ctx) {
   string command;
 
   // Generating VHDL testbench
@@ -173,20 +195,131 @@ void execute_vhdl_testbench(const VerificationContext &ctx) {
   log_inf(LOG_TAG, "Copying supplementary files: [" + command + "]");
   execute_command(command);
 
-#ifdef XSIM
+  if (ctx.simulator == "modelsim") {
+    // Generating modelsim script for the simulation
+    command = "cp " +
+              extract_parent_directory_path(get_application_directory()) +
+              "/resources/modelsim.ini " + ctx.get_hls_verify_dir() +
+              "/modelsim.ini";
+    log_inf(LOG_TAG, "Copying supplementary files: [" + command + "]");
+    execute_command(command);
+    generate_modelsim_scripts(ctx);
+    return "vsim -c -do " + ctx.get_modelsim_do_file_name();
+  }
+  if (ctx.simulator == "ghdl") {
+    // Generating GHDL script for the simulation
+    generate_ghdl_scripts(ctx);
+    return "bash run_ghdl.sh";
+  }
+  if (ctx.simulator != "xsim")
+    throw string("Unknown simulator " + ctx.simulator + ".");
   // Generating xsim script for the simulation
   generate_xsim_scripts(ctx);
-#else
-  // Generating modelsim script for the simulation
-  command = "cp " + extract_parent_directory_path(get_application_directory()) +
-            "/resources/modelsim.ini " + ctx.get_hls_verify_dir() +
-            "/modelsim.ini";
-  log_inf(LOG_TAG, "Copying supplementary files: [" + command + "]");
+  return "bash run_xsim.sh";
+}
+
+static string extract_file_name(const string &path) {
+  return path.substr(path.find_last_of('/') + 1);
+}
+
+static string get_absolute_path(const string &path) {
+  char result[PATH_MAX];
+  if (realpath(path.c_str(), result) == NULL)
+    throw string("Cannot resolve path " + path + ".");
+  return string(result);
+}
+
+// Splits the input transactions into contiguous shards, each simulated in its
+// own copy of the directory layout under ./shards, and merges the outputs of
+// the shards back in transaction order. This assumes that the transactions
+// are independent, which holds as every transaction reloads all the inputs
+// of the design.
+static void execute_sharded_vhdl_testbench(const VerificationContext &ctx) {
+  string command;
+  string input_dir = ctx.get_input_vector_dir();
+  vector<string> input_files = get_list_of_files_in_directory(input_dir, ".dat");
+  vector<vector<string>> inputs;
+  for (auto &file : input_files)
+    inputs.push_back(read_transactions(input_dir + "/" + file));
+  int transaction_num = inputs.empty() ? 0 : inputs[0].size();
+  for (auto &transactions : inputs)
+    if (transactions.size() != transaction_num)
+      throw string("Input files have different numbers of transactions.");
+  int shard_num = min(ctx.jobs, transaction_num);
+  if (shard_num < 1)
+    shard_num = 1;
+
+  // Sources are linked from the original VHDL_SRC, except the files
+  // generated for each shard
+  string vhdl_src_dir = get_absolute_path(ctx.get_vhdl_src_dir());
+  string tb_name = "hls_verify_" + ctx.get_vhdl_duv_entity_name() + "_tb.vhd";
+  vector<string> sources;
+  for (auto &extension : {".vhd", ".v"})
+    for (auto &file :
+         get_list_of_files_in_directory(vhdl_src_dir, extension))
+      if (file != tb_name && file != "two_port_RAM.vhd" &&
+          file != "single_argument.vhd" && file != "simpackage.vhd")
+        sources.push_back(file);
+
+  char cwd[PATH_MAX];
+  if (getcwd(cwd, PATH_MAX) == NULL)
+    throw string("Cannot get the current directory.");
+  string hls_verify_dir = cwd;
+
+  command = "rm -rf shards";
+  log_inf(LOG_TAG, "Cleaning simulation shards [" + command + "]");
   execute_command(command);
-  generate_modelsim_scripts(ctx);
-#endif
 
-  // Cleaning-up exisiting outputs
+  vector<string> shard_dirs, commands;
+  for (int i = 0; i < shard_num; i++) {
+    int begin = (long)i * transaction_num / shard_num;
+    int end = (long)(i + 1) * transaction_num / shard_num;
+    string shard_dir = hls_verify_dir + "/shards/shard_" + to_string(i);
+    string shard_verify_dir = shard_dir + "/HLS_VERIFY";
+    string shard_src_dir = shard_dir + "/" + extract_file_name(vhdl_src_dir);
+    string shard_input_dir =
+        shard_dir + "/" + extract_file_name(get_absolute_path(input_dir));
+    string shard_out_dir =
+        shard_dir + "/" + extract_file_name(ctx.get_vhdl_out_dir());
+    execute_command("mkdir -p " + shard_verify_dir + " " + shard_src_dir +
+                    " " + shard_input_dir + " " + shard_out_dir);
+
+    for (int j = 0; j < input_files.size(); j++)
+      write_transactions(shard_input_dir + "/" + input_files[j],
+                         vector<string>(inputs[j].begin() + begin,
+                                        inputs[j].begin() + end));
+    for (auto &file : sources)
+      execute_command("ln -s " + vhdl_src_dir + "/" + file + " " +
+                      shard_src_dir + "/" + file);
+    if (access("ieee_proposed", F_OK) == 0)
+      execute_command("ln -s " + hls_verify_dir + "/ieee_proposed " +
+                      shard_verify_dir + "/ieee_proposed");
+
+    // The context paths are relative to HLS_VERIFY
+    if (chdir(shard_verify_dir.c_str()) != 0)
+      throw string("Cannot enter " + shard_verify_dir + ".");
+    try {
+      commands.push_back(prepare_vhdl_testbench(ctx));
+    } catch (...) {
+      chdir(hls_verify_dir.c_str());
+      throw;
+    }
+    chdir(hls_verify_dir.c_str());
+    shard_dirs.push_back(shard_verify_dir);
+  }
+
+  log_inf(LOG_TAG, "Executing " + to_string(shard_num) +
+                       " simulations of " + to_string(transaction_num) +
+                       " transactions");
+  vector<thread> workers;
+  for (int i = 0; i < shard_num; i++) {
+    command = "cd " + shard_dirs[i] + " && " + commands[i] + " > sim.log 2>&1";
+    workers.push_back(thread([command]() { system(command.c_str()); }));
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  // Merging the outputs of the shards
 
   command = "rm -rf " + ctx.get_vhdl_out_dir();
   log_inf(LOG_TAG, "Cleaning VHDL output files [" + command + "]");
@@ -196,14 +329,61 @@ void execute_vhdl_testbench(const VerificationContext &ctx) {
   log_inf(LOG_TAG, "Creating VHDL output files directory [" + command + "]");
   execute_command(command);
 
-#ifdef XSIM
-  // Executing xsim
-  system("bash run_xsim.sh");
-#else
-  // Executing modelsim
-  command = "vsim -c -do " + ctx.get_modelsim_do_file_name();
-  log_inf(LOG_TAG, "Executing modelsim: [" + command + "]");
-  system(("vsim -c -do " + ctx.get_modelsim_do_file_name()).c_str());
-#endif
+  const vector<CFunctionParameter> &output_params = ctx.get_fuv_output_params();
+  for (auto it = output_params.begin(); it != output_params.end(); it++) {
+    string file_name = extract_file_name(ctx.get_vhdl_out_path(*it));
+    vector<string> outputs;
+    for (int i = 0; i < shard_num; i++) {
+      string shard_out_dir =
+          shard_dirs[i] + "/../" + extract_file_name(ctx.get_vhdl_out_dir());
+      vector<string> transactions =
+          read_transactions(shard_out_dir + "/" + file_name);
+      int expected = (long)(i + 1) * transaction_num / shard_num -
+                     (long)i * transaction_num / shard_num;
+      if (transactions.size() != expected)
+        log_err(LOG_TAG, "Simulation of " + shard_dirs[i] + " produced " +
+                             to_string(transactions.size()) + " of " +
+                             to_string(expected) + " transactions of [" +
+                             it->parameter_name + "], see sim.log.");
+      outputs.insert(outputs.end(), transactions.begin(), transactions.end());
+    }
+    write_transactions(ctx.get_vhdl_out_path(*it), outputs);
+  }
+}
+
+void check_vhdl_testbench_outputs(const VerificationContext &ctx) {
+  const vector<CFunctionParameter> &output_params = ctx.get_fuv_output_params();
+  cout << "\n--- Comparison Results ---\n" << endl;
+  for (auto it = output_params.begin(); it != output_params.end(); it++) {
+    bool result =
+        compare_files(ctx.get_ref_out_path(*it), ctx.get_vhdl_out_path(*it),
+                      ctx.get_token_comparator(*it));
+    cout << "Comparison of [" + it->parameter_name + "] : "
+         << (result ? "Pass" : "Fail") << endl;
+  }
+  cout << "\n--------------------------\n" << endl;
+}
+
+void execute_vhdl_testbench(const VerificationContext &ctx) {
+  if (ctx.jobs > 1) {
+    execute_sharded_vhdl_testbench(ctx);
+    return;
+  }
+
+  string command = prepare_vhdl_testbench(ctx);
+
+  // Cleaning-up exisiting outputs
+
+  string cleanup = "rm -rf " + ctx.get_vhdl_out_dir();
+  log_inf(LOG_TAG, "Cleaning VHDL output files [" + cleanup + "]");
+  execute_command(cleanup);
+
+  cleanup = "mkdir -p " + ctx.get_vhdl_out_dir();
+  log_inf(LOG_TAG, "Creating VHDL output files directory [" + cleanup + "]");
+  execute_command(cleanup);
+
+  // Executing the simulator
+  log_inf(LOG_TAG, "Executing " + ctx.simulator + ": [" + command + "]");
+  system(command.c_str());
 }
 } // namespace hls_verify
@@ -30,6 +30,12 @@ namespace hls_verify {
      */
     void generate_modelsim_scripts(const VerificationContext& ctx);
 
+    /**
+     * Generate a GHDL script to run the generated VHDL testbench.
+     * @param ctx verification context
+     */
+    void generate_ghdl_scripts(const VerificationContext& ctx);
+
     /**
      * Compares all generated VHDL testbench outputs against references.
      * @param ctx verification context
@@ -37,7 +43,9 @@ namespace hls_verify {
     void check_vhdl_testbench_outputs(const VerificationContext& ctx);
     
     /**
-     * Execute the VHDL testbench of the given verification context.
+     * Execute the VHDL testbench of the given verification context. With
+     * more than one job, the input transactions are split into shards that
+     * are simulated concurrently, and their outputs are merged.
      * @param ctx verification context
      */
     void execute_vhdl_testbench(const VerificationContext& ctx);
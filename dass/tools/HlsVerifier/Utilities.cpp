@@ -1,7 +1,11 @@
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -13,59 +17,86 @@ const string LOG_TAG = "UTIL";
 namespace hls_verify {
 
 bool TokenCompare::compare(const string &token1, const string &token2) const {
-  return token1 == token2;
+  return compare(token1.data(), token1.size(), token2.data(), token2.size());
 }
 
-IntegerCompare::IntegerCompare(bool is_signed) : is_signed(is_signed) {}
+bool TokenCompare::compare(const char *token1, size_t length1,
+                           const char *token2, size_t length2) const {
+  return length1 == length2 && memcmp(token1, token2, length1) == 0;
+}
 
-bool IntegerCompare::compare(const string &token1, const string &token2) const {
-  long long i1;
-  long long i2;
-  string t1 = token1.substr(2);
-  string t2 = token2.substr(2);
-  while (t1.length() < t2.length()) {
-    t1 = ((t2[0] >= '8' && is_signed) ? "f" : "0") + t1;
-  }
-  while (t2.length() < t1.length()) {
-    t2 = ((t1[0] >= '8' && is_signed) ? "f" : "0") + t2;
+// Parses a hexadecimal token with an optional 0x prefix. Like "is >> hex", the
+// value saturates if it does not fit.
+template <typename T> static T parse_hex(const char *token, size_t length) {
+  size_t i = 0;
+  if (length >= 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X'))
+    i = 2;
+  T value = 0;
+  for (; i < length; i++) {
+    char c = token[i];
+    T digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      digit = c - 'A' + 10;
+    else
+      break;
+    if (value >> (sizeof(T) * 8 - 4))
+      return ~T(0);
+    value = (value << 4) | digit;
   }
+  return value;
+}
 
-  //        stringstream is1(token1);
-  //        stringstream is2(token2);
-  //        is1 >> hex >> i1;
-  //        is2 >> hex >> i2;
+IntegerCompare::IntegerCompare(bool is_signed) : is_signed(is_signed) {}
 
-  //        cout << "t1 " << t1 << " t2 " << t2 << endl;
-  return (t1 == t2);
+bool IntegerCompare::compare(const char *token1, size_t length1,
+                             const char *token2, size_t length2) const {
+  // Skip the 0x prefix, then compare the digits as if the shorter token was
+  // extended to the length of the longer one
+  const char *t1 = token1 + min<size_t>(2, length1);
+  const char *t2 = token2 + min<size_t>(2, length2);
+  size_t n1 = length1 - (t1 - token1);
+  size_t n2 = length2 - (t2 - token2);
+  size_t n = max(n1, n2);
+  char pad1 = (n1 < n2 && t2[0] >= '8' && is_signed) ? 'f' : '0';
+  char pad2 = (n2 < n1 && t1[0] >= '8' && is_signed) ? 'f' : '0';
+  for (size_t i = 0; i < n; i++) {
+    char c1 = (i < n - n1) ? pad1 : t1[i - (n - n1)];
+    char c2 = (i < n - n2) ? pad2 : t2[i - (n - n2)];
+    if (c1 != c2)
+      return false;
+  }
+  return true;
 }
 
 FloatCompare::FloatCompare(float threshold) : threshold(threshold) {}
 
-bool FloatCompare::compare(const string &token1, const string &token2) const {
-  if (token1 == token2)
+bool FloatCompare::compare(const char *token1, size_t length1,
+                           const char *token2, size_t length2) const {
+  if (TokenCompare::compare(token1, length1, token2, length2))
     return true;
-  unsigned int i1;
-  unsigned int i2;
-  stringstream is1(token1);
-  stringstream is2(token2);
-  is1 >> hex >> i1;
-  is2 >> hex >> i2;
-  // printf("%s %s %f %f %f %x %x\n", token1.c_str(), token2.c_str(), threshold,
-  // (*((float *) &i1)), (*((float *) &i1)), i1, i2);
-  float diff = abs(*((float *)&i1) - *((float *)&i2));
+  unsigned int i1 = parse_hex<unsigned int>(token1, length1);
+  unsigned int i2 = parse_hex<unsigned int>(token2, length2);
+  float f1, f2;
+  memcpy(&f1, &i1, sizeof(float));
+  memcpy(&f2, &i2, sizeof(float));
+  float diff = fabs(f1 - f2);
   return (diff < threshold);
 }
 
 DoubleCompare::DoubleCompare(double threshold) : threshold(threshold) {}
 
-bool DoubleCompare::compare(const string &token1, const string &token2) const {
-  unsigned long long i1;
-  unsigned long long i2;
-  stringstream is1(token1);
-  stringstream is2(token2);
-  is1 >> hex >> i1;
-  is2 >> hex >> i2;
-  double diff = abs(*((double *)&i1) - *((double *)&i2));
+bool DoubleCompare::compare(const char *token1, size_t length1,
+                            const char *token2, size_t length2) const {
+  unsigned long long i1 = parse_hex<unsigned long long>(token1, length1);
+  unsigned long long i2 = parse_hex<unsigned long long>(token2, length2);
+  double d1, d2;
+  memcpy(&d1, &i1, sizeof(double));
+  memcpy(&d2, &i2, sizeof(double));
+  double diff = fabs(d1 - d2);
   return (diff < threshold);
 }
 
@@ -84,54 +115,133 @@ string get_application_directory() {
   return string(result, (count > 0) ? count : 0);
 }
 
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+  MappedFile(const string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      size = st.st_size;
+      if (size == 0)
+        valid = true;
+      else {
+        void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+          data = static_cast<const char *>(addr);
+          madvise(addr, size, MADV_SEQUENTIAL);
+          valid = true;
+        }
+      }
+    }
+    close(fd);
+  }
+  ~MappedFile() {
+    if (data)
+      munmap(const_cast<char *>(data), size);
+  }
+  bool is_open() const { return valid; }
+  const char *begin() const { return data; }
+  const char *end() const { return data + size; }
+
+private:
+  const char *data = nullptr;
+  size_t size = 0;
+  bool valid = false;
+};
+
+// Splits a mapped file into white space separated tokens
+class TokenReader {
+public:
+  TokenReader(const MappedFile &file) : pos(file.begin()), end(file.end()) {}
+
+  // Returns false at the end of the file, where the token is empty
+  bool next(const char *&token, size_t &length) {
+    while (pos != end && isspace(*pos)) {
+      if (*pos == '\n')
+        line++;
+      pos++;
+    }
+    token = pos;
+    while (pos != end && !isspace(*pos))
+      pos++;
+    length = pos - token;
+    return length > 0;
+  }
+
+  int get_line() const { return line; }
+
+private:
+  const char *pos, *end;
+  int line = 1;
+};
+
+static bool is_token(const char *token, size_t length, const char *str) {
+  return length == strlen(str) && memcmp(token, str, length) == 0;
+}
+
 bool compare_files(const string &refFile, const string &outFile,
                    const TokenCompare *token_compare) {
-  ifstream ref(refFile.c_str());
-  ifstream out(outFile.c_str());
-  if (!ref.is_open()) {
+  MappedFile refMap(refFile), outMap(outFile);
+  if (!refMap.is_open()) {
     log_err(LOG_TAG, "Reference file does not exist: " + refFile);
     return false;
   }
-  if (!out.is_open()) {
+  if (!outMap.is_open()) {
     log_err(LOG_TAG, "Output file does not exist: " + outFile);
     return false;
   }
-  string str1, str2;
-  int tn1, tn2;
-  while (ref >> str1) {
-    out >> str2;
-    if (str1 == "[[[runtime]]]") {
-      if (str2 == "[[[runtime]]]") {
+  TokenReader ref(refMap), out(outMap);
+  const char *str1, *str2;
+  size_t len1, len2;
+  string tn1, tn2;
+  int mismatches = 0;
+  while (ref.next(str1, len1)) {
+    out.next(str2, len2);
+    if (is_token(str1, len1, "[[[runtime]]]")) {
+      if (is_token(str2, len2, "[[[runtime]]]")) {
         continue;
       } else {
-        log_err("COMPARE 1", "Token mismatch: [" + str1 + "] and [" + str2 +
+        log_err("COMPARE 1", "Token mismatch: [" + string(str1, len1) +
+                                 "] and [" + string(str2, len2) +
                                  "] are not equal.");
         return false;
       }
     }
-    if (str1 == "[[[/runtime]]]") {
+    if (is_token(str1, len1, "[[[/runtime]]]")) {
       break;
     }
-    if (str1 == "[[transaction]]") {
-      ref >> tn1;
-      out >> tn2;
-      if (tn1 != tn2) {
+    if (is_token(str1, len1, "[[transaction]]")) {
+      ref.next(str1, len1);
+      out.next(str2, len2);
+      tn1 = string(str1, len1);
+      tn2 = string(str2, len2);
+      if (atoi(tn1.c_str()) != atoi(tn2.c_str())) {
         log_err("COMPARE", "Transaction number mismatch!");
         return false;
       }
       continue;
     }
-    if (str1 == "[[/transaction]]") {
+    if (is_token(str1, len1, "[[/transaction]]")) {
       continue;
     }
-    if (!token_compare->compare(str1, str2)) {
-      log_err("COMPARE 2", "Token mismatch: [" + str1 + "] and [" + str2 +
-                               "] are not equal (at transaction id " +
-                               to_string(tn1) + ").");
-      return false;
+    if (!token_compare->compare(str1, len1, str2, len2)) {
+      log_err("COMPARE 2", "Token mismatch: [" + string(str1, len1) +
+                               "] and [" + string(str2, len2) +
+                               "] are not equal (at transaction id " + tn1 +
+                               ", line " + to_string(ref.get_line()) + " of " +
+                               refFile + ", line " +
+                               to_string(out.get_line()) + " of " + outFile +
+                               ").");
+      mismatches++;
     }
   }
-  return true;
+  if (mismatches > 0)
+    log_err("COMPARE", to_string(mismatches) + " token(s) mismatch between " +
+                           refFile + " and " + outFile + ".");
+  return mismatches == 0;
 }
 
 string trim(const string &str) {
@@ -174,6 +284,41 @@ int get_number_of_transactions(const string &input_path) {
   return result;
 }
 
+vector<string> read_transactions(const string &input_path) {
+  vector<string> result;
+  ifstream inf(input_path.c_str());
+  string line;
+  bool in_transaction = false;
+  while (getline(inf, line)) {
+    string dt = trim(line);
+    if (dt == "[[[/runtime]]]")
+      break;
+    if (dt.substr(0, 15) == "[[transaction]]") {
+      result.push_back("");
+      in_transaction = true;
+    } else if (dt == "[[/transaction]]") {
+      in_transaction = false;
+    } else if (in_transaction) {
+      result.back() += line + "\n";
+    }
+  }
+  inf.close();
+  return result;
+}
+
+void write_transactions(const string &output_path,
+                        const vector<string> &transactions) {
+  ofstream outf(output_path.c_str());
+  outf << "[[[runtime]]]" << endl;
+  for (int i = 0; i < transactions.size(); i++) {
+    outf << "[[transaction]] " << i << endl;
+    outf << transactions[i];
+    outf << "[[/transaction]]" << endl;
+  }
+  outf << "[[[/runtime]]]" << endl;
+  outf.close();
+}
+
 bool execute_command(const string &command) {
   int status = system(command.c_str());
   if (status != 0) {
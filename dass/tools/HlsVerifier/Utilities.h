@@ -10,16 +10,22 @@ using namespace std;
 
 namespace hls_verify {
 
+    /**
+     * Compares two tokens of the data files. Tokens are passed as character
+     * ranges of the mapped files, so comparing does not allocate.
+     */
     class TokenCompare {
     public:
-        virtual bool compare(const string& token1, const string& token2) const;
+        bool compare(const string& token1, const string& token2) const;
+        virtual bool compare(const char* token1, size_t length1, const char* token2, size_t length2) const;
     };
 
     class IntegerCompare : public TokenCompare {
     public:
         IntegerCompare() = default;
         IntegerCompare(bool is_signed);
-        virtual bool compare(const string& token1, const string& token2) const;
+        using TokenCompare::compare;
+        virtual bool compare(const char* token1, size_t length1, const char* token2, size_t length2) const;
         
     private:
         bool is_signed;
@@ -29,7 +35,8 @@ namespace hls_verify {
     public:
         FloatCompare() = default;
         FloatCompare(float threshold);
-        virtual bool compare(const string& token1, const string& token2) const;
+        using TokenCompare::compare;
+        virtual bool compare(const char* token1, size_t length1, const char* token2, size_t length2) const;
     private:
         float threshold;
     };
@@ -38,7 +45,8 @@ namespace hls_verify {
     public:
         DoubleCompare() = default;
         DoubleCompare(double threshold);
-        virtual bool compare(const string& token1, const string& token2) const;
+        using TokenCompare::compare;
+        virtual bool compare(const char* token1, size_t length1, const char* token2, size_t length2) const;
     private:
         double threshold;
     };
@@ -57,7 +65,10 @@ namespace hls_verify {
     string get_application_directory();
 
     /**
-     * Compares two data files using a given token comparator.
+     * Compares two data files using a given token comparator. Both files are
+     * memory mapped and scanned once. Every token mismatch is reported with its
+     * transaction and line, the comparison only stops early if the transactions
+     * of the two files are not aligned.
      * @param refFilePath path of the reference data file
      * @param outFile path of the other data file
      * @param token_compare the comparator to be used for comparing two tokens
@@ -87,6 +98,22 @@ namespace hls_verify {
      */
     int get_number_of_transactions(const string& input_path);
 
+    /**
+     * Read the transactions of a data file.
+     * @param input_path path of the data file
+     * @return the lines between each "[[transaction]]" and "[[/transaction]]"
+     * pair, one string per transaction.
+     */
+    vector<string> read_transactions(const string& input_path);
+
+    /**
+     * Write a data file with the given transactions, numbered from 0.
+     * @param output_path path of the data file
+     * @param transactions the lines of each transaction, as returned by
+     * read_transactions
+     */
+    void write_transactions(const string& output_path, const vector<string>& transactions);
+
     /**
      * Execute the given command in a shell.
      * @param command the command to be executed
@@ -84,6 +84,11 @@ namespace hls_verify {
 
         
         bool use_addr_width_32;
+        // Simulator of the VHDL testbench: xsim, modelsim or ghdl
+        string simulator = "xsim";
+        // Number of simulations to run in parallel, each on a shard of the
+        // input transactions
+        int jobs = 1;
     private:
         Properties properties;
         CFunction fuv;
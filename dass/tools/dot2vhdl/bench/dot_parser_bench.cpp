@@ -0,0 +1,199 @@
+/*
+*  C++ Implementation: dot2Vhdl
+*
+* Description: micro-benchmark of parse_dot against the former line-based
+* parser on synthetic Dynamatic-style graphs. Both parsers must produce the
+* same netlist; the run fails otherwise.
+*
+* Usage: dot_parser_bench [blocks] [repeats]
+*
+* Copyright: See COPYING file that comes with this distribution
+*
+*/
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dot_parser.h"
+
+using namespace std;
+
+void parse_dot_legacy(string filename);
+
+#define BENCH_FILENAME "dot_parser_bench"
+
+// Writes a graph of 'blocks' copies of a small loop body (constant, adder,
+// fork, buffers, branch, load/store) all hanging off one memory controller,
+// so both the edge count and the MC port lists grow with 'blocks'.
+static int write_graph(const string &filename, int blocks) {
+  ofstream dot(filename + ".dot");
+  int edges = 0;
+  string mc_in = "in1:32*c0";
+  string mc_out;
+  int mc_inputs = 1;
+  int mc_outputs = 0;
+  stringstream connections;
+
+  dot << "Digraph G {" << endl;
+  dot << "\tsplines=spline;" << endl;
+  dot << "//DHLS version: 0.1.1\" [shape = \"none\" pos = \"20,20!\"]" << endl;
+  dot << "\t\tsubgraph cluster_0 {" << endl;
+  dot << "\t\tcolor = \"darkgreen\";" << endl;
+  dot << "\t\tlabel = \"block1\";" << endl;
+  dot << "\t\t\"start_0\" [type = \"Entry\", control= \"true\", bbID= 1, in = "
+         "\"in1:0\", out = \"out1:0\"];"
+      << endl;
+
+  for (int k = 0; k < blocks; k++) {
+    string s = "_" + to_string(k);
+    string prev = (k == 0) ? "start_0" : "branch_" + to_string(k - 1);
+
+    dot << "\t\t\"cst" << s << "\" [type = \"Constant\", bbID= 2, in = "
+        << "\"in1:32\", out = \"out1:32\", value = \"0x0000000" << k % 8
+        << "\"];" << endl;
+    dot << "\t\t\"add" << s << "\" [type = \"Operator\", bbID= 2, op = "
+        << "\"add_op\", in = \"in1:32 in2:32 \", out = \"out1:32 \", "
+        << "delay=2.287, latency=0, II=1];" << endl;
+    dot << "\t\t\"fork" << s << "\" [type = \"Fork\", bbID= 2, in = "
+        << "\"in1:32\", out = \"out1:32 out2:32 out3:32\"];" << endl;
+    dot << "\t\t\"buf" << s << "\" [type = \"Buffer\", in = \"in1:32\", out = "
+        << "\"out1:32\", bbID = 2, slots=" << (k % 4 + 1)
+        << ", transparent=" << (k % 2 ? "true" : "false") << "];" << endl;
+    dot << "\t\t\"load" << s << "\" [type = \"Operator\", bbID= 2, op = "
+        << "\"mc_load_op\", bbID= 2, portId= " << k << ", offset= 0, in = "
+        << "\"in1:32 in2:32 \", out = \"out1:32 out2:32 \", delay=1.412, "
+        << "latency=2, II=1];" << endl;
+    dot << "\t\t\"branch" << s << "\" [type = \"Branch\", bbID= 2,  in = "
+        << "\"in1:32 in2?:1\", out = \"out1+:32 out2-:32\"];" << endl;
+
+    mc_in += " in" + to_string(++mc_inputs) + ":32*l" + to_string(k) + "a";
+    mc_out += "out" + to_string(++mc_outputs) + ":32*l" + to_string(k) + "d ";
+
+    // The first edge comes from the previous block's branch (or start_0).
+    const char *edge_list[][4] = {
+        {"", "1", "add", "1"},           {"cst", "1", "add", "2"},
+        {"add", "1", "fork", "1"},       {"fork", "1", "buf", "1"},
+        {"fork", "2", "load", "2"},      {"buf", "1", "branch", "1"},
+        {"fork", "3", "branch", "2"},    {"load", "1", "cst", "1"},
+    };
+    for (auto &e : edge_list) {
+      string from = (*e[0] == '\0') ? prev : string(e[0]) + s;
+      connections << "\t\"" << from << "\" -> \"" << e[2] << s
+                  << "\" [color = \"red\", from = \"out" << e[1]
+                  << "\", to = \"in" << e[3] << "\", arrowhead=normal];"
+                  << endl;
+      edges++;
+    }
+    connections << "\t\"load" << s << "\" -> \"MC_x\" [color = \"darkgreen\", "
+                << "from = \"out2\", to = \"in" << mc_inputs
+                << "\", arrowhead=normal];" << endl;
+    connections << "\t\"MC_x\" -> \"load" << s << "\" [color = \"darkgreen\", "
+                << "from = \"out" << mc_outputs << "\", to = \"in1\", "
+                << "arrowhead=normal];" << endl;
+    edges += 2;
+  }
+
+  dot << "\t\t\"MC_x\" [type = \"MC\", bbID= 0, in = \"" << mc_in
+      << "\", out = \"" << mc_out << "out" << mc_outputs + 1
+      << ":0*e\", memory = \"x\", bbcount = 1, ldcount = " << blocks
+      << ", stcount = 0];" << endl;
+  dot << "\t}" << endl;
+  dot << connections.str();
+  dot << "}" << endl;
+
+  return edges;
+}
+
+// Folds everything the VHDL writer reads from the netlist into one value.
+static size_t netlist_hash(void) {
+  size_t h = components_in_netlist;
+  hash<string> hs;
+  auto mix = [&h](size_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  };
+
+  for (int i = 0; i < components_in_netlist; i++) {
+    NODE_T &n = nodes[i];
+    mix(hs(n.name));
+    mix(hs(n.type));
+    mix(hs(n.component_operator));
+    mix(hs(n.memory));
+    mix(n.component_value);
+    mix(n.slots);
+    mix(n.trasparent);
+    mix(n.bbcount);
+    mix(n.load_count);
+    mix(n.store_count);
+    mix(n.data_size);
+    mix(n.address_size);
+    mix(n.portId);
+    mix(n.offset);
+    mix(n.inputs.size);
+    mix(n.outputs.size);
+    for (int p = 0; p < n.inputs.size; p++) {
+      INPUT_T &in = n.inputs.input[p];
+      mix(in.bit_size);
+      mix(in.prev_nodes_id);
+      mix(in.port);
+      mix(hs(in.type));
+      mix(hs(in.info_type));
+    }
+    for (int p = 0; p < n.outputs.size; p++) {
+      OUTPUT_T &out = n.outputs.output[p];
+      mix(out.bit_size);
+      mix(out.next_nodes_id);
+      mix(out.next_nodes_port);
+      mix(out.port);
+      mix(hs(out.type));
+      mix(hs(out.info_type));
+    }
+  }
+  return h;
+}
+
+static double best_of(int repeats, void (*parser)(string)) {
+  double best = 1e30;
+  for (int r = 0; r < repeats; r++) {
+    auto start = chrono::steady_clock::now();
+    parser(BENCH_FILENAME);
+    chrono::duration<double, milli> elapsed =
+        chrono::steady_clock::now() - start;
+    if (elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  int blocks = (argc > 1) ? atoi(argv[1]) : 2000;
+  int repeats = (argc > 2) ? atoi(argv[2]) : 3;
+
+  int edges = write_graph(BENCH_FILENAME, blocks);
+
+  double legacy_ms = best_of(repeats, parse_dot_legacy);
+  size_t legacy_hash = netlist_hash();
+  int legacy_nodes = components_in_netlist;
+
+  double stream_ms = best_of(repeats, parse_dot);
+  size_t stream_hash = netlist_hash();
+
+  cout << "graph: " << components_in_netlist << " nodes, " << edges
+       << " edges" << endl;
+  cout << "line-based parser : " << legacy_ms << " ms" << endl;
+  cout << "streaming parser  : " << stream_ms << " ms" << endl;
+  cout << "speedup           : " << legacy_ms / stream_ms << "x" << endl;
+
+  remove(BENCH_FILENAME ".dot");
+
+  if (legacy_hash != stream_hash || legacy_nodes != components_in_netlist) {
+    cout << "ERROR: parsers disagree on the netlist" << endl;
+    return 1;
+  }
+  return 0;
+}
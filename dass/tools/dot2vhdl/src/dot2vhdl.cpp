@@ -13,6 +13,9 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "stdlib.h"
 #include <string.h>
 #include "dot2vhdl.h"
@@ -36,6 +39,8 @@ string input_filename[MAX_INPUT_FILES];
 string output_filename[MAX_INPUT_FILES];
 string top_level_filename;
 int dot_input_files = 0;
+
+static mutex console_lock;
     
 void arguments_parser ( int argc, char *argv[] )
 {		
@@ -79,6 +84,11 @@ void arguments_parser ( int argc, char *argv[] )
             }
             break;
         default:
+            if ( argc > 3 && argc <= MAX_INPUT_FILES + 1 )
+            {
+                // List of .dot files, one per function
+                break;
+            }
             printf( "Invalid arguments \n\rTry %s --help for more informations\n\r\n\r\n\r", argv[0] );
             exit ( 0 );
             break;
@@ -90,6 +100,29 @@ void arguments_parser ( int argc, char *argv[] )
 
 
 
+// Parses, checks and emits one input file on the calling thread, which owns
+// its own netlist. Returns the number of LSQs found in the file.
+int generate_file ( vhdl_writer &vhdl_writer, int indx )
+{
+    int first_lsq = lsqs_in_netlist;
+
+    parse_dot ( input_filename[indx] );
+
+    check_netlist ( );
+
+    {
+        lock_guard<mutex> lock ( console_lock );
+
+        cout << "Parsing "<< input_filename[indx] << ".dot" << endl;
+        report_instances ();
+        cout << "Generating " << output_filename[indx] << ".vhd" << endl;
+    }
+
+    vhdl_writer.write_vhdl ( output_filename[indx] , indx );
+
+    return lsqs_in_netlist - first_lsq;
+}
+
 int main( int argc, char* argv[] )
 {
    
@@ -107,31 +140,67 @@ int main( int argc, char* argv[] )
 
     for ( int indx = 0; indx < dot_input_files; indx++ )
     {
-        
         input_filename[indx] = argv[indx+1];
         output_filename[indx] = argv[indx+1];
+    }
+
+    if ( report_area_mode )
+    {
+        cout << "Parsing "<< input_filename[0] << ".dot" << endl;
+
+        parse_dot ( input_filename[0] );
 
-        cout << "Parsing "<< input_filename[indx] << ".dot" << endl;
-        
-        parse_dot ( input_filename[indx] );
-        
         check_netlist ( );
-        
-        
-        if ( report_area_mode )
-        {
-            report_instances ();
-            return 0;
-            //report_area ();
-        }
-        else
+
+        report_instances ();
+        return 0;
+        //report_area ();
+    }
+
+    // The files are independent: all but the last one are spread over a
+    // pool of threads, the last one is emitted here since the LSQ generator
+    // and the EDA scripts below work on its netlist.
+    int last_file = dot_input_files - 1;
+    int lsqs_in_file[MAX_INPUT_FILES] = { 0 };
+    atomic<int> next_file ( 0 );
+    vector<thread> workers;
+
+    int threads = thread::hardware_concurrency ();
+    if ( threads < 1 )
+    {
+        threads = 1;
+    }
+    if ( threads > last_file )
+    {
+        threads = last_file;
+    }
+
+    for ( int worker = 0; worker < threads; worker++ )
+    {
+        workers.emplace_back ( [&] ()
         {
-            report_instances ();
-            cout << "Generating " << output_filename[indx] << ".vhd" << endl;
-            vhdl_writer.write_vhdl ( output_filename[indx] , indx );
-        }
+            int indx;
+            while ( ( indx = next_file++ ) < last_file )
+            {
+                lsqs_in_file[indx] = generate_file ( vhdl_writer, indx );
+            }
+        } );
     }
-    
+
+    lsqs_in_file[last_file] = generate_file ( vhdl_writer, last_file );
+
+    for ( auto &worker : workers )
+    {
+        worker.join ();
+    }
+
+    // Number the LSQs as if the files had been parsed one after the other.
+    int first_lsq = 0;
+    for ( int indx = 0; indx < last_file; indx++ )
+    {
+        first_lsq += lsqs_in_file[indx];
+    }
+    offset_lsq_indices ( first_lsq );
     
     //vhdl_writer.write_tb_wrapper ( top_level_filename );
     
@@ -14,155 +14,372 @@
 #include "assert.h"
 #include "dot2vhdl.h"
 #include "string_utils.h"
+#include "sys_utils.h"
 #include "vhdl_writer.h"
 #include <algorithm>
 #include <cctype>
+#include <climits>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <stdlib.h> /* exit, EXIT_FAILURE */
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
 
-NODE_T nodes[MAX_NODES];
+thread_local dyn_array<NODE_T> nodes;
 
-int components_in_netlist;
-int lsqs_in_netlist;
+thread_local int components_in_netlist;
+thread_local int lsqs_in_netlist;
 
-#define COMPONENT_DESCRIPTION_LINE 0
-#define COMPONENT_CONNECTION_LINE 1
+// Name -> node id of the components parsed so far, used to resolve edges.
+static thread_local unordered_map<string, int> node_ids;
 
-bool check_line(string line) {
+const string *interned_string::intern(const string &s) {
+  static const string empty_string;
+  static unordered_set<string> pool;
+  static mutex pool_lock;
 
-  if (line.find("type") != std::string::npos) {
-    return COMPONENT_DESCRIPTION_LINE;
-  }
-  if (line.find(">") != std::string::npos) {
-    return COMPONENT_CONNECTION_LINE;
+  if (s.empty()) {
+    return &empty_string;
   }
+  lock_guard<mutex> lock(pool_lock);
+  return &*pool.insert(s).first;
 }
 
-string get_value(string parameter) {
-  vector<string> v;
-  string_split(parameter, '=', v);
-  if (v.size() > 0) {
-    return v[1];
-  }
+ostream &operator<<(ostream &os, const interned_string &s) {
+  return os << s.get();
 }
 
-string get_component_type(string parameters) {
-
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-  nodes[components_in_netlist].component_type = COMPONENT_GENERIC;
-
-  return type;
+// The parser works directly on views into the memory-mapped .dot file: every
+// line is scanned once, split into attributes in place and each attribute key
+// is dispatched through attr_key() instead of probing the text for every
+// known key.
+
+// Characters string_clean drops from attribute values.
+#define CLEAN_CHARS "\t \"];"
+
+enum {
+  ATTR_UNKNOWN,
+  ATTR_TYPE,
+  ATTR_IN,
+  ATTR_OUT,
+  ATTR_OP,
+  ATTR_VALUE,
+  ATTR_CONTROL,
+  ATTR_SLOTS,
+  ATTR_TRANSPARENT,
+  ATTR_MEMORY,
+  ATTR_BBCOUNT,
+  ATTR_LDCOUNT,
+  ATTR_STCOUNT,
+  ATTR_MEM_ADDRESS,
+  ATTR_BBID,
+  ATTR_PORTID,
+  ATTR_OFFSET,
+  ATTR_FIFODEPTH,
+  ATTR_NUMLOADS,
+  ATTR_NUMSTORES,
+  ATTR_LOADOFFSETS,
+  ATTR_STOREOFFSETS,
+  ATTR_LOADPORTS,
+  ATTR_STOREPORTS,
+  ATTR_ORDERINGS,
+  ATTR_CONSTANTS,
+  ATTR_FROM,
+  ATTR_TO
+};
+
+static int attr_key(string_view key) {
+  switch (key.size()) {
+  case 2:
+    if (key == "in")
+      return ATTR_IN;
+    if (key == "op")
+      return ATTR_OP;
+    if (key == "to")
+      return ATTR_TO;
+    break;
+  case 3:
+    if (key == "out")
+      return ATTR_OUT;
+    break;
+  case 4:
+    if (key == "type")
+      return ATTR_TYPE;
+    if (key == "bbId")
+      return ATTR_BBID;
+    if (key == "from")
+      return ATTR_FROM;
+    break;
+  case 5:
+    if (key == "value")
+      return ATTR_VALUE;
+    if (key == "slots")
+      return ATTR_SLOTS;
+    break;
+  case 6:
+    if (key == "memory")
+      return ATTR_MEMORY;
+    if (key == "portId")
+      return ATTR_PORTID;
+    if (key == "offset")
+      return ATTR_OFFSET;
+    break;
+  case 7:
+    if (key == "control")
+      return ATTR_CONTROL;
+    if (key == "bbcount")
+      return ATTR_BBCOUNT;
+    if (key == "ldcount")
+      return ATTR_LDCOUNT;
+    if (key == "stcount")
+      return ATTR_STCOUNT;
+    break;
+  case 8:
+    if (key == "numLoads")
+      return ATTR_NUMLOADS;
+    break;
+  case 9:
+    if (key == "fifoDepth")
+      return ATTR_FIFODEPTH;
+    if (key == "numStores")
+      return ATTR_NUMSTORES;
+    if (key == "loadPorts")
+      return ATTR_LOADPORTS;
+    if (key == "orderings")
+      return ATTR_ORDERINGS;
+    if (key == "constants")
+      return ATTR_CONSTANTS;
+    break;
+  case 10:
+    if (key == "storePorts")
+      return ATTR_STOREPORTS;
+    break;
+  case 11:
+    if (key == "transparent")
+      return ATTR_TRANSPARENT;
+    if (key == "mem_address")
+      return ATTR_MEM_ADDRESS;
+    if (key == "loadOffsets")
+      return ATTR_LOADOFFSETS;
+    break;
+  case 12:
+    if (key == "storeOffsets")
+      return ATTR_STOREOFFSETS;
+    break;
+  }
+  return ATTR_UNKNOWN;
 }
 
-string get_component_operator(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-
-  return type;
+// Returns 'text' without any of 'chars'. The view itself is returned when
+// there is nothing to drop, otherwise the filtered copy lives in 'scratch'.
+static string_view strip_chars(string_view text, const char *chars,
+                               string &scratch) {
+  size_t pos = text.find_first_of(chars);
+  if (pos == string_view::npos) {
+    return text;
+  }
+  scratch.assign(text.data(), pos);
+  for (; pos < text.size(); pos++) {
+    if (strchr(chars, text[pos]) == 0) {
+      scratch += text[pos];
+    }
+  }
+  return scratch;
 }
 
-string get_component_value(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-  return type;
+static string_view trim_chars(string_view text, const char *chars) {
+  size_t first = text.find_first_not_of(chars);
+  if (first == string_view::npos) {
+    return string_view();
+  }
+  size_t last = text.find_last_not_of(chars);
+  return text.substr(first, last - first + 1);
 }
 
-bool get_component_control(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-
-  return (((type == "true")) ? TRUE : FALSE);
+// Same conversion as stoi_p: leading blanks and a sign are accepted, parsing
+// stops at the first non-digit and anything unparsable or out of range is 0.
+static int to_int(string_view text) {
+  size_t pos = 0;
+  while (pos < text.size() && isspace((unsigned char)text[pos])) {
+    pos++;
+  }
+  bool negative = false;
+  if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+    negative = (text[pos] == '-');
+    pos++;
+  }
+  long long value = 0;
+  bool has_digits = false;
+  while (pos < text.size() && isdigit((unsigned char)text[pos])) {
+    value = value * 10 + (text[pos] - '0');
+    if (value > (long long)INT_MAX + 1) {
+      return 0;
+    }
+    has_digits = true;
+    pos++;
+  }
+  if (!has_digits) {
+    return 0;
+  }
+  value = negative ? -value : value;
+  if (value > INT_MAX || value < INT_MIN) {
+    return 0;
+  }
+  return (int)value;
 }
 
-int get_component_slots(string parameters) {
-
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-  return stoi_p(type);
+// Calls field() for every piece of 'text' separated by 'separator', with the
+// string_split convention that a text without separator yields no pieces.
+template <typename F>
+static void for_each_field(string_view text, char separator, F field) {
+  size_t pos = text.find(separator);
+  if (pos == string_view::npos) {
+    return;
+  }
+  size_t start = 0;
+  while (pos != string_view::npos) {
+    field(text.substr(start, pos - start));
+    start = pos + 1;
+    pos = text.find(separator, start);
+  }
+  field(text.substr(start));
 }
 
-bool get_component_transparent(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-
-  return (((type == "true")) ? TRUE : FALSE);
+// Value of a "key = value" attribute, up to the next '=' if any.
+static string_view attr_value(string_view parameter) {
+  size_t eq = parameter.find('=');
+  if (eq == string_view::npos) {
+    return string_view();
+  }
+  size_t next = parameter.find('=', eq + 1);
+  return parameter.substr(eq + 1, next == string_view::npos
+                                      ? string_view::npos
+                                      : next - eq - 1);
 }
 
-string get_component_memory(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-  return type;
+static string_view attr_name(string_view parameter) {
+  return trim_chars(parameter.substr(0, parameter.find('=')), " \t\"");
 }
 
-string get_component_numloads(string parameters) {
-  // parameters = string_clean( parameters );
+// Returns the highest N among the "<prefix>N" port names found in the list,
+// i.e. the number of ports the component declares.
+int get_port_count(string_view ports, string_view prefix) {
+  int count = 0;
+  size_t pos = ports.find(prefix);
+
+  while (pos != string_view::npos) {
+    pos += prefix.size();
+    int indx = 0;
+    bool has_digits = false;
+    while (pos < ports.size() && isdigit((unsigned char)ports[pos])) {
+      indx = indx * 10 + (ports[pos] - '0');
+      has_digits = true;
+      pos++;
+    }
+    if (has_digits && indx > count) {
+      count = indx;
+    }
+    pos = ports.find(prefix, pos);
+  }
 
-  string type = get_value(parameters);
-  return type;
+  return count;
 }
 
-string get_component_numstores(string parameters) {
-  // parameters = string_clean( parameters );
-
-  string type = get_value(parameters);
-  return type;
-}
+// Decodes one "inN:<bits>*<type><port><info>" port descriptor.
+template <typename PORT_T>
+static void parse_port(string_view text, PORT_T &port, string &scratch) {
+  size_t colon = text.find(':');
+  port.bit_size = 32;
+  if (colon != string_view::npos) {
+    size_t next = text.find(':', colon + 1);
+    string_view bits = text.substr(
+        colon + 1, next == string_view::npos ? next : next - colon - 1);
+    int bit_size = to_int(strip_chars(bits, "\"];", scratch));
+    port.bit_size = (bit_size == 0) ? 1 : bit_size; // if 0 force to 1!!
+  }
 
-int get_component_bbcount(string parameters) {
-  parameters = string_clean(parameters);
+  size_t star = text.find('*');
+  if (star == string_view::npos) {
+    port.type = "u";
+    port.port = 0;
+    port.info_type = "u";
+    return;
+  }
+  size_t next = text.find('*', star + 1);
+  string_view tag = text.substr(
+      star + 1, next == string_view::npos ? next : next - star - 1);
+  if (tag.empty()) {
+    port.type = "u";
+    port.port = 0;
+    port.info_type = "u";
+    return;
+  }
 
-  string type = get_value(parameters);
-  return stoi_p(type);
+  port.type = string(1, tag[0]);
+  size_t digits = 1;
+  while (digits < tag.size() && isdigit((unsigned char)tag[digits])) {
+    digits++;
+  }
+  port.port = (tag.size() > 1) ? to_int(tag.substr(1, digits - 1)) : 0;
+  port.info_type = (tag.size() > 2) ? string(1, tag[2]) : string("u");
 }
 
-int get_component_bbId(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-  return stoi_p(type);
+// Parses an in=/out= port list into 'ports' and returns the declared count.
+template <typename PORT_T>
+static int parse_port_list(string_view value, string_view prefix,
+                           const char *drop, dyn_array<PORT_T> &ports,
+                           int &parsed) {
+  string list_scratch, scratch;
+  string_view list = strip_chars(value, drop, list_scratch);
+  int size = get_port_count(list, prefix);
+
+  parsed = 0;
+  if (size == 1) {
+    parse_port(list, ports[0], scratch);
+    parsed = 1;
+  } else {
+    for_each_field(list, ' ', [&](string_view port) {
+      if (!port.empty()) {
+        parse_port(port, ports[parsed], scratch);
+        parsed++;
+      }
+    });
+  }
+  return size;
 }
 
-int get_component_portId(string parameters) {
-  parameters = string_clean(parameters);
+static void parse_component_inputs(string_view value, NODE_T &node) {
+  IN_T inputs;
+  int parsed;
 
-  string type = get_value(parameters);
-  return stoi_p(type);
-}
+  inputs.size = parse_port_list(value, "in", "\t\"", inputs.input, parsed);
 
-int get_component_offset(string parameters) {
-  parameters = string_clean(parameters);
+  for (int indx = 0; indx < parsed; indx++) {
+    if (inputs.input[indx].info_type == "a") {
+      node.address_size = inputs.input[indx].bit_size;
+    }
+    if (inputs.input[indx].info_type == "d") {
+      node.data_size = inputs.input[indx].bit_size;
+    }
+  }
 
-  string type = get_value(parameters);
-  return stoi_p(type);
+  node.inputs = move(inputs);
 }
 
-bool get_component_mem_address(string parameters) {
-  parameters = string_clean(parameters);
-
-  string type = get_value(parameters);
-
-  return (((type == "true")) ? TRUE : FALSE);
-}
+static void parse_component_outputs(string_view value, NODE_T &node) {
+  OUT_T outputs;
+  int parsed;
 
-int get_component_constants(string parameters) {
-  parameters = string_clean(parameters);
+  outputs.size = parse_port_list(value, "out", "\"", outputs.output, parsed);
 
-  string type = get_value(parameters);
-  return stoi_p(type);
+  node.outputs = move(outputs);
 }
 
 vector<vector<int>> get_component_orderings(string parameter) {
@@ -200,707 +417,338 @@ vector<vector<int>> get_component_orderings(string parameter) {
   return orderings;
 }
 
-string get_input_type(string in) {
-  vector<string> par;
-  string ret_val = "u";
-
-  string_split(in, '*', par);
+string get_component_name(string_view name) {
+  string scratch;
+  string name_ret(strip_chars(name, "\t\" ", scratch));
 
-  if (par.size()) {
-    par[1].erase(remove(par[1].begin(), par[1].end(), '"'), par[1].end());
-    ret_val = par[1].at(0);
+  if (!name_ret.empty() && name_ret[0] == '_') {
+    // cout << "***WARNING***: Vivado doesn't support names with '_' as first
+    // character. Component "<< name <<" renamed as ";
+    name_ret.erase(0, 1);
+    // cout << name << endl;
   }
 
-  return ret_val;
+  return name_ret;
 }
 
-int get_input_port(string in) {
-  vector<string> par;
-  int ret_val = 0;
-  string val;
-
-  string_split(in, '*', par);
-
-  if (par.size()) {
-    par[1].erase(remove(par[1].begin(), par[1].end(), '"'), par[1].end());
-    if (par[1].size() > 1) {
-      val = "";
-      int i = 1;
-      while (par[1].size() > i && isdigit(par[1].at(i))) {
-        val += par[1].at(i);
-        i++;
-      }
-
-      // val = par[1].at(1);
-      ret_val = stoi_p(val);
-    }
-  }
-
-  // cout << in << ":" << ret_val << endl;
-
-  return ret_val;
+static int find_node(const string &name) {
+  unordered_map<string, int>::const_iterator it = node_ids.find(name);
+  return (it == node_ids.end()) ? COMPONENT_NOT_FOUND : it->second;
 }
 
-string get_info_type(string in) {
-  vector<string> par;
-  string ret_val = "u";
-
-  string_split(in, '*', par);
-
-  if (par.size()) {
-    par[1].erase(remove(par[1].begin(), par[1].end(), '"'), par[1].end());
-    if (par[1].size() > 2) {
-      ret_val = par[1].at(2);
-    }
-  }
-
-  return ret_val;
+// Parses the attributes of one "from = "outN", to = "inM"" edge.
+static int get_connection_port(string_view value, const char *drop,
+                               size_t prefix) {
+  string scratch;
+  string_view port = strip_chars(value, drop, scratch);
+  return to_int(port.size() > prefix ? port.substr(prefix) : string_view()) -
+         1;
 }
 
-int get_input_size(string in) {
-
-  vector<string> bit_sizes;
-  int ret_val = 32;
-
-  string_split(in, ':', bit_sizes);
-
-  if (bit_sizes.size()) {
-    bit_sizes[1].erase(remove(bit_sizes[1].begin(), bit_sizes[1].end(), '"'),
-                       bit_sizes[1].end());
-    bit_sizes[1].erase(remove(bit_sizes[1].begin(), bit_sizes[1].end(), ']'),
-                       bit_sizes[1].end());
-    bit_sizes[1].erase(remove(bit_sizes[1].begin(), bit_sizes[1].end(), ';'),
-                       bit_sizes[1].end());
+void parse_connections(string_view line) {
+  int current_node_id;
+  int next_node_id;
 
-    if (stoi_p(bit_sizes[1]) == 0) // if 0 force to 1!!
-    {
-      ret_val = 1;
-    } else {
-      ret_val = stoi_p(bit_sizes[1]);
-    }
+  size_t arrow = line.find('>');
+  string_view rest = line.substr(arrow + 1);
+  rest = rest.substr(0, rest.find('>'));
+  size_t bracket = rest.find('[');
+  if (bracket == string_view::npos) {
+    return;
   }
 
-  return ret_val;
-}
-
-IN_T get_component_inputs(string in, int components_in_netlist) {
-  vector<string> v;
-  vector<string> par;
-  vector<string> bit_sizes;
-  IN_T inputs;
-
-  in.erase(remove(in.begin(), in.end(), '\t'), in.end());
-
-  inputs.size = 0;
-
-  string_split(in, '=', par);
+  string scratch;
+  string from_name(strip_chars(line.substr(0, arrow), " -\t\"", scratch));
+  string to_name(strip_chars(rest.substr(0, bracket), " \t\"", scratch));
 
-  if (par.size()) {
-    par[1].erase(remove(par[1].begin(), par[1].end(), '"'), par[1].end());
+  if (!from_name.empty() && from_name[0] == '_') {
+    from_name.erase(0, 1);
   }
-
-  string test_string;
-
-  for (int indx = MAX_INPUTS; indx > 0; indx--) {
-    test_string = "in";
-    test_string += to_string(indx);
-    if (par[1].find(test_string) != std::string::npos) {
-      inputs.size = indx;
-      break;
-    }
+  if (!to_name.empty() && to_name[0] == '_') {
+    to_name.erase(0, 1);
   }
 
-  int input_indx = 0;
+  current_node_id = find_node(from_name);
+  next_node_id = find_node(to_name);
 
-  if (inputs.size == 1) {
-    inputs.input[input_indx].bit_size = get_input_size(par[1]);
+  string_view attributes = rest.substr(bracket + 1);
+  attributes = attributes.substr(0, attributes.find('['));
 
-    inputs.input[input_indx].type = get_input_type(par[1]);
-    inputs.input[input_indx].port = get_input_port(par[1]);
-    inputs.input[input_indx].info_type = get_info_type(par[1]);
-    if (inputs.input[input_indx].info_type == "a") {
-      nodes[components_in_netlist].address_size =
-          inputs.input[input_indx].bit_size;
-    }
-    if (inputs.input[input_indx].info_type == "d") {
-      nodes[components_in_netlist].data_size =
-          inputs.input[input_indx].bit_size;
-    }
-
-  } else {
-    string_split(par[1], ' ', v);
-
-    if (v.size()) {
-      for (int indx = 0; indx < v.size(); indx++) {
-        if (!(v[indx].empty())) {
-          inputs.input[input_indx].bit_size = get_input_size(v[indx]);
-          inputs.input[input_indx].type = get_input_type(v[indx]);
-          inputs.input[input_indx].port = get_input_port(v[indx]);
-          inputs.input[input_indx].info_type = get_info_type(v[indx]);
-          if (inputs.input[input_indx].info_type == "a") {
-            nodes[components_in_netlist].address_size =
-                inputs.input[input_indx].bit_size;
-          }
-          if (inputs.input[input_indx].info_type == "d") {
-            nodes[components_in_netlist].data_size =
-                inputs.input[input_indx].bit_size;
-          }
-
-          // cout << nodes[components_in_netlist].name << " input "<< input_indx
-          // << ":" << inputs.input[input_indx].type << endl;
-          input_indx++;
-        }
-      }
-    }
-  }
-
-  return inputs;
-}
-
-OUT_T get_component_outputs(string parameters) {
-  vector<string> v;
-  vector<string> bit_sizes;
-  vector<string> par;
-
-  OUT_T outputs;
-
-  string_split(parameters, '=', par);
-
-  if (par.size()) {
-    par[1].erase(remove(par[1].begin(), par[1].end(), '"'), par[1].end());
-  }
-
-  string test_string;
-
-  for (int indx = MAX_OUTPUTS; indx > 0; indx--) {
-    test_string = "out";
-    test_string += to_string(indx);
-    if (parameters.find(test_string) != std::string::npos) {
-      outputs.size = indx;
+  int input_indx = 0;
+  int output_indx = 0;
+  for_each_field(attributes, ',', [&](string_view parameter) {
+    switch (attr_key(attr_name(parameter))) {
+    case ATTR_FROM:
+      output_indx = get_connection_port(attr_value(parameter), " \t\"", 3);
+      break;
+    case ATTR_TO:
+      input_indx = get_connection_port(attr_value(parameter), " \t\";]", 2);
       break;
     }
-  }
+  });
 
-  int output_indx = 0;
+  if (current_node_id != COMPONENT_NOT_FOUND &&
+      next_node_id != COMPONENT_NOT_FOUND) {
+
+    nodes[current_node_id].outputs.output[output_indx].next_nodes_id =
+        next_node_id;
+    nodes[current_node_id].outputs.output[output_indx].next_nodes_port =
+        input_indx;
+    nodes[next_node_id].inputs.input[input_indx].prev_nodes_id =
+        current_node_id;
 
-  if (outputs.size == 1) {
-    outputs.output[output_indx].bit_size = get_input_size(par[1]);
-    outputs.output[output_indx].type = get_input_type(par[1]);
-    outputs.output[output_indx].port = get_input_port(par[1]);
-    outputs.output[output_indx].info_type = get_info_type(par[1]);
   } else {
-    string_split(par[1], ' ', v);
-    if (v.size()) {
-      for (int indx = 0; indx < v.size(); indx++) {
-        if (!(v[indx].empty())) {
-          outputs.output[output_indx].bit_size = get_input_size(v[indx]);
-          outputs.output[output_indx].type = get_input_type(v[indx]);
-          outputs.output[output_indx].port = get_input_port(v[indx]);
-          outputs.output[output_indx].info_type = get_info_type(v[indx]);
-          output_indx++;
-        }
-      }
-    }
-  }
+    cout << "Netlist Error" << endl;
 
-  return outputs;
-}
+    if (current_node_id == COMPONENT_NOT_FOUND) {
+      cout << "Node Description " << from_name
+           << " not found. Not ID assigned" << endl;
+    } else
 
-string get_component_name(string name) {
-  string name_ret;
-  name.erase(remove(name.begin(), name.end(), '\t'), name.end());
-  name.erase(remove(name.begin(), name.end(), '"'), name.end());
-  name.erase(remove(name.begin(), name.end(), ' '), name.end());
+        if (next_node_id == COMPONENT_NOT_FOUND) {
+      cout << "Node ID" << current_node_id
+           << "Node Name: " << nodes[current_node_id].name
+           << " has not next node for output " << output_indx << endl;
+    }
 
-  if (name[0] == '_') {
-    // cout << "***WARNING***: Vivado doesn't support names with '_' as first
-    // character. Component "<< name <<" renamed as ";
-    name.replace(0, 1, "");
-    // cout << name << endl;
+    cout << "Exiting without producing netlist" << endl;
+    exit(0);
   }
-
-  name_ret = name;
-  return name_ret;
 }
 
-void parse_connections(string line) {
-
-  vector<string> v;
-  vector<string> from_to;
-  vector<string> parameters;
-
-  int current_node_id;
-  int next_node_id;
-
-  string_split(line, '>', v);
-
-  int i;
-  if (v.size() > 0) {
-    v[0].erase(remove(v[0].begin(), v[0].end(), ' '), v[0].end());
-    v[0].erase(remove(v[0].begin(), v[0].end(), '-'), v[0].end());
-    v[0].erase(remove(v[0].begin(), v[0].end(), '\t'), v[0].end());
-    v[0].erase(remove(v[0].begin(), v[0].end(), '"'), v[0].end());
-
-    string_split(v[1], '[', from_to);
-    from_to[0].erase(remove(from_to[0].begin(), from_to[0].end(), ' '),
-                     from_to[0].end());
-    from_to[0].erase(remove(from_to[0].begin(), from_to[0].end(), '\t'),
-                     from_to[0].end());
-    from_to[0].erase(remove(from_to[0].begin(), from_to[0].end(), '"'),
-                     from_to[0].end());
-
-    if (v[0][0] == '_') {
-      v[0].replace(0, 1, "");
-    }
-
-    if (from_to[0][0] == '_') {
-      from_to[0].replace(0, 1, "");
+static void parse_attribute(NODE_T &node, string_view parameter) {
+  string scratch;
+  string_view raw = attr_value(parameter);
+
+  switch (attr_key(attr_name(parameter))) {
+  case ATTR_TYPE:
+    node.type = string(strip_chars(raw, CLEAN_CHARS, scratch));
+    node.component_type = COMPONENT_GENERIC;
+    node.component_operator =
+        node.type; // For the component without an operator, sets the entity
+                   // type
+    if (node.type == "LSQ") {
+      node.lsq_indx = lsqs_in_netlist;
+      lsqs_in_netlist++;
     }
-
-    current_node_id = COMPONENT_NOT_FOUND;
-    for (i = 0; i < components_in_netlist; i++) {
-      if (nodes[i].name.compare(v[0]) == 0) {
-        current_node_id = i;
-        break;
-      }
+    break;
+  case ATTR_IN:
+    parse_component_inputs(raw, node);
+    break;
+  case ATTR_OUT:
+    parse_component_outputs(raw, node);
+    break;
+  case ATTR_OP:
+    node.component_operator = string(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
+  case ATTR_VALUE:
+    node.component_value =
+        strtoul(string(strip_chars(raw, CLEAN_CHARS, scratch)).c_str(), 0, 16);
+    break;
+  case ATTR_CONTROL:
+    node.component_control = (strip_chars(raw, CLEAN_CHARS, scratch) == "true");
+    break;
+  case ATTR_SLOTS:
+    node.slots = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+
+    switch (node.slots) {
+    case 1: // if slots = 1
+    case 2: // put elasticBuffer (ignore transparent parameter)
+    case 0: // put elasticBuffer (ignore transparent parameter)
+      break;
+    default: // > 2
+      node.type = "Fifo";
+      node.component_operator =
+          node.type; // For the component without an operator, sets the entity
+                     // type
+      break;
     }
-    next_node_id = COMPONENT_NOT_FOUND;
-
-    for (i = 0; i < components_in_netlist; i++) {
-      if (nodes[i].name.compare(from_to[0]) == 0) {
-        next_node_id = i;
-        break;
-      }
+    break;
+  case ATTR_TRANSPARENT:
+    node.trasparent = (strip_chars(raw, CLEAN_CHARS, scratch) == "true");
+    break;
+  case ATTR_MEMORY:
+    node.memory = string(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
+  case ATTR_BBCOUNT:
+    node.bbcount = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+
+    if (node.bbcount == 0) {
+      node.bbcount = 1;
+      node.inputs.size += 1;
+      node.inputs.input[node.inputs.size - 1].type = "c";
+      node.inputs.input[node.inputs.size - 1].bit_size = 32;
+      node.inputs.input[node.inputs.size - 1].info_type =
+          "fake"; // Andrea 20200128 Try to force 0 to inputs.
+      node.inputs.input[node.inputs.size - 1].port = 0; // Andrea 20200211
     }
-
-    string_split(from_to[1], ',', parameters);
-
-    int input_indx;
-    int output_indx;
-    int indx;
-    for (indx = 0; indx < parameters.size(); indx++) {
-      if (parameters[indx].find("from") != std::string::npos) {
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), ' '),
-            parameters[indx].end());
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), '\t'),
-            parameters[indx].end());
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), '"'),
-            parameters[indx].end());
-        parameters[indx].erase(0, 8);
-        output_indx = stoi_p(parameters[indx]);
-        output_indx--;
-      }
-      if (parameters[indx].find("to") != std::string::npos) {
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), ' '),
-            parameters[indx].end());
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), '\t'),
-            parameters[indx].end());
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), '"'),
-            parameters[indx].end());
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), ';'),
-            parameters[indx].end());
-        parameters[indx].erase(
-            remove(parameters[indx].begin(), parameters[indx].end(), ']'),
-            parameters[indx].end());
-
-        parameters[indx].erase(0, 5);
-
-        input_indx = stoi_p(parameters[indx]);
-        input_indx--;
-      }
+    break;
+  case ATTR_LDCOUNT:
+    node.load_count = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    if (node.load_count == 0) {
+      node.load_count = 1;
+      node.inputs.size += 1;
+      node.inputs.input[node.inputs.size - 1].type = "l";
+      node.inputs.input[node.inputs.size - 1].info_type = "a";
+      node.inputs.input[node.inputs.size - 1].bit_size = 32;
+      node.inputs.input[node.inputs.size - 1].port = 0; // Andrea 20200424
+
+      node.outputs.size += 1;
+      node.outputs.output[node.outputs.size - 1].type = "l";
+      node.outputs.output[node.outputs.size - 1].info_type = "a";
+      node.outputs.output[node.outputs.size - 1].bit_size = 32;
+      node.outputs.output[node.outputs.size - 1].port = 0; // Andrea 20200424
     }
-
-    if (current_node_id != COMPONENT_NOT_FOUND &&
-        next_node_id != COMPONENT_NOT_FOUND) {
-
-      nodes[current_node_id].outputs.output[output_indx].next_nodes_id =
-          next_node_id;
-      nodes[current_node_id].outputs.output[output_indx].next_nodes_port =
-          input_indx;
-      nodes[next_node_id].inputs.input[input_indx].prev_nodes_id =
-          current_node_id;
-
-    } else {
-      cout << "Netlist Error" << endl;
-
-      if (current_node_id == COMPONENT_NOT_FOUND) {
-        cout << "Node Description " << v[0] << " not found. Not ID assigned"
-             << endl;
-      } else
-
-          if (next_node_id == COMPONENT_NOT_FOUND) {
-        cout << "Node ID" << current_node_id
-             << "Node Name: " << nodes[current_node_id].name
-             << " has not next node for output " << output_indx << endl;
-      }
-
-      cout << "Exiting without producing netlist" << endl;
-      exit(0);
+    break;
+  case ATTR_STCOUNT:
+    node.store_count = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    if (node.store_count == 0) {
+      node.store_count = 1;
+      node.inputs.size += 1;
+      node.inputs.input[node.inputs.size - 1].type = "s";
+      node.inputs.input[node.inputs.size - 1].info_type = "a";
+      node.inputs.input[node.inputs.size - 1].port = 0;      // Andrea 20200424
+      node.inputs.input[node.inputs.size - 1].bit_size = 32; // Andrea 20200424
+
+      node.inputs.size += 1;
+      node.inputs.input[node.inputs.size - 1].type = "s";
+      node.inputs.input[node.inputs.size - 1].info_type = "d";
+      node.inputs.input[node.inputs.size - 1].port = 0;      // Andrea 20200424
+      node.inputs.input[node.inputs.size - 1].bit_size = 32; // Andrea 20200424
     }
+    break;
+  case ATTR_MEM_ADDRESS:
+    node.mem_address = (strip_chars(raw, CLEAN_CHARS, scratch) == "true");
+    break;
+  case ATTR_BBID:
+    node.bbId = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
+  case ATTR_PORTID:
+    node.portId = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
+  case ATTR_OFFSET:
+    node.offset = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
+  case ATTR_FIFODEPTH:
+    node.fifodepth = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
+  // The LSQ parameter lists are kept verbatim, the LSQ generator rewrites
+  // them into JSON arrays.
+  case ATTR_NUMLOADS:
+    node.numLoads = string(raw);
+    break;
+  case ATTR_NUMSTORES:
+    node.numStores = string(raw);
+    break;
+  case ATTR_LOADOFFSETS:
+    node.loadOffsets = string(raw);
+    break;
+  case ATTR_STOREOFFSETS:
+    node.storeOffsets = string(raw);
+    break;
+  case ATTR_LOADPORTS:
+    node.loadPorts = string(raw);
+    break;
+  case ATTR_STOREPORTS:
+    node.storePorts = stripExtension(string(raw), "];");
+    break;
+  case ATTR_ORDERINGS:
+    node.orderings = get_component_orderings(string(parameter));
+    break;
+  case ATTR_CONSTANTS:
+    node.constants = to_int(strip_chars(raw, CLEAN_CHARS, scratch));
+    break;
   }
 }
 
-string check_comments(string line) {
-  vector<string> v;
-  string_split(line, COMMENT_CHARACTER, v);
+void parse_components(string_view name, string_view attributes) {
+  NODE_T &node = nodes[components_in_netlist];
 
-  if (v.size() > 0)
-    return v[0];
-  else
-    return line;
-}
-
-void parse_components(string v_0, string v_1) {
-  vector<string> parameters;
-  string parameter;
-
-  nodes[components_in_netlist].name = get_component_name(v_0);
-  if (!(nodes[components_in_netlist]
-            .name.empty())) // Check if the name is not empty
+  node.name = get_component_name(name);
+  if (!(node.name.empty())) // Check if the name is not empty
   {
+    for_each_field(attributes, ',', [&](string_view parameter) {
+      parse_attribute(node, parameter);
+    });
 
-    string_split(v_1, ',', parameters);
-
-    int indx;
-    for (indx = 0; indx < parameters.size(); indx++) {
-      parameter = string_remove_blank(parameters[indx]);
-
-      if (parameter.find("type") != std::string::npos) {
-        nodes[components_in_netlist].type =
-            get_component_type(parameters[indx]);
-        nodes[components_in_netlist].component_operator =
-            nodes[components_in_netlist].type; // For the component without an
-                                               // operator, sets the entity type
-        if (nodes[components_in_netlist].type == "LSQ") {
-          nodes[components_in_netlist].lsq_indx = lsqs_in_netlist;
-          lsqs_in_netlist++;
-        }
-      }
-      if (parameter.find("in=") != std::string::npos) {
-        // cout << " nodes " << nodes[components_in_netlist].name << endl;
-        nodes[components_in_netlist].inputs =
-            get_component_inputs(parameters[indx], components_in_netlist);
-      }
-      if (parameter.find("out=") != std::string::npos) {
-        // cout << " nodes " << nodes[components_in_netlist].name << endl;
-        nodes[components_in_netlist].outputs =
-            get_component_outputs(parameters[indx]);
-      }
-      if (parameter.find("op") != std::string::npos) {
-        nodes[components_in_netlist].component_operator =
-            get_component_operator(parameters[indx]);
-      }
-      if (parameter.find("value") != std::string::npos) {
-        // nodes[components_in_netlist].component_value = protected_stoi(
-        // get_component_value ( parameters[indx] ) );
-        unsigned long int hex_value;
-        hex_value =
-            strtoul(get_component_value(parameters[indx]).c_str(), 0, 16);
-        nodes[components_in_netlist].component_value = hex_value;
-      }
-      if (parameter.find("control") != std::string::npos) {
-        nodes[components_in_netlist].component_control =
-            get_component_control(parameters[indx]);
-      }
-      if (parameter.find("slots") != std::string::npos) {
-        nodes[components_in_netlist].slots =
-            get_component_slots(parameters[indx]);
-
-        // cout << "nodes[components_in_netlist].slots" <<
-        // nodes[components_in_netlist].slots;
-
-        switch (nodes[components_in_netlist].slots) {
-        case 1: // if slots = 1
-        //                                 if (
-        //                                 nodes[components_in_netlist].trasparent
-        //                                 )
-        //                                 {
-        //                                      // if transparent = true -> put
-        //                                      TEHB
-        //                                     nodes[components_in_netlist].type
-        //                                     = "TEHB";
-        //                                 }
-        //                                 else
-        //                                 {
-        //                                     // if transparent = false -> put
-        //                                     OEHB
-        //                                     nodes[components_in_netlist].type
-        //                                     = "OEHB";
-        //
-        //                                 }
-        //                                 break;
-        case 2: // put elasticBuffer (ignore transparent parameter)
-        case 0: // put elasticBuffer (ignore transparent parameter)
-            ;
-          break;
-        default: // > 2
-          nodes[components_in_netlist].type = "Fifo";
-          nodes[components_in_netlist].component_operator =
-              nodes[components_in_netlist].type; // For the component without an
-                                                 // operator, sets the entity
-                                                 // type
-          break;
-        }
-      }
-      if (parameter.find("transparent") != std::string::npos) {
-        nodes[components_in_netlist].trasparent =
-            get_component_transparent(parameters[indx]);
-      }
-      if (parameter.find("memory") != std::string::npos) {
-        nodes[components_in_netlist].memory =
-            get_component_memory(parameters[indx]);
-      }
-      if (parameter.find("bbcount") != std::string::npos) {
-        nodes[components_in_netlist].bbcount =
-            get_component_bbcount(parameters[indx]);
-
-        // cout << nodes[components_in_netlist].name << " bbcount " <<
-        // nodes[components_in_netlist].bbcount << endl;
-        // cout << nodes[components_in_netlist].name << " inputs.size " <<
-        // nodes[components_in_netlist].inputs.size << endl;
-
-        if (nodes[components_in_netlist].bbcount == 0) {
-          nodes[components_in_netlist].bbcount = 1;
-          nodes[components_in_netlist].inputs.size += 1;
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .type = "c";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .bit_size = 32;
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .info_type = "fake"; // Andrea 20200128 Try to force 0 to inputs.
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .port = 0; // Andrea 20200211
-        }
-
-        // cout << nodes[components_in_netlist].name << " inputs.size " <<
-        // nodes[components_in_netlist].inputs.size << endl;
-      }
-      if (parameter.find("ldcount") != std::string::npos) {
-        nodes[components_in_netlist].load_count =
-            get_component_bbcount(parameters[indx]);
-        if (nodes[components_in_netlist].load_count == 0) {
-          nodes[components_in_netlist].load_count = 1;
-          nodes[components_in_netlist].inputs.size += 1;
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .type = "l";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .info_type = "a";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .bit_size = 32;
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .port = 0; // Andrea 20200424
-          //                     nodes[components_in_netlist].inputs.size += 1;
-          //                     nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].type
-          //                     = "l";
-          //                     nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].info_type
-          //                     = "d";
-          //
-
-          nodes[components_in_netlist].outputs.size += 1;
-          nodes[components_in_netlist]
-              .outputs.output[nodes[components_in_netlist].outputs.size - 1]
-              .type = "l";
-          nodes[components_in_netlist]
-              .outputs.output[nodes[components_in_netlist].outputs.size - 1]
-              .info_type = "a";
-          nodes[components_in_netlist]
-              .outputs.output[nodes[components_in_netlist].outputs.size - 1]
-              .bit_size = 32;
-          nodes[components_in_netlist]
-              .outputs.output[nodes[components_in_netlist].outputs.size - 1]
-              .port = 0; // Andrea 20200424
-        }
-      }
-      if (parameter.find("stcount") != std::string::npos) {
-        nodes[components_in_netlist].store_count =
-            get_component_bbcount(parameters[indx]);
-        if (nodes[components_in_netlist].store_count == 0) {
-          nodes[components_in_netlist].store_count = 1;
-          nodes[components_in_netlist].inputs.size += 1;
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .type = "s";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .info_type = "a";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .port = 0; // Andrea 20200424
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .bit_size = 32; // Andrea 20200424
-
-          nodes[components_in_netlist].inputs.size += 1;
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .type = "s";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .info_type = "d";
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .port = 0; // Andrea 20200424
-          nodes[components_in_netlist]
-              .inputs.input[nodes[components_in_netlist].inputs.size - 1]
-              .bit_size = 32; // Andrea 20200424
-        }
-      }
-      if (parameter.find("mem_address") != std::string::npos) {
-        nodes[components_in_netlist].mem_address =
-            get_component_mem_address(parameters[indx]);
-      }
-      if (parameter.find("bbId") != std::string::npos) {
-        nodes[components_in_netlist].bbId =
-            get_component_bbId(parameters[indx]);
-      }
-      if (parameter.find("portId") != std::string::npos) {
-        nodes[components_in_netlist].portId =
-            get_component_portId(parameters[indx]);
-        // cout << "component id "<< components_in_netlist << " portId " <<
-        // nodes[components_in_netlist].portId << endl;
-      }
-      if (parameter.find("offset") != std::string::npos) {
-        nodes[components_in_netlist].offset =
-            get_component_offset(parameters[indx]);
-      }
-
-      if (parameter.find("fifoDepth") != std::string::npos) {
-        nodes[components_in_netlist].fifodepth =
-            get_component_bbcount(parameters[indx]);
-      }
-
-      if (parameter.find("numLoads") != std::string::npos) {
-        nodes[components_in_netlist].numLoads =
-            get_component_numloads(parameters[indx]);
-        // cout << "numLoads" << nodes[components_in_netlist].numLoads << endl;
-      }
-      if (parameter.find("numStores") != std::string::npos) {
-        nodes[components_in_netlist].numStores =
-            get_component_numstores(parameters[indx]);
-      }
-      if (parameter.find("loadOffsets") != std::string::npos) {
-        nodes[components_in_netlist].loadOffsets =
-            get_component_numstores(parameters[indx]);
-      }
-      if (parameter.find("storeOffsets") != std::string::npos) {
-        nodes[components_in_netlist].storeOffsets =
-            get_component_numstores(parameters[indx]);
-      }
-      if (parameter.find("loadPorts") != std::string::npos) {
-        nodes[components_in_netlist].loadPorts =
-            get_component_numstores(parameters[indx]);
-      }
-      if (parameter.find("storePorts") != std::string::npos) {
-        // nodes[components_in_netlist].storePorts = get_component_numstores(
-        // parameters[indx] );
-        nodes[components_in_netlist].storePorts =
-            stripExtension(get_component_numstores(parameters[indx]), "];");
-      }
-      if (parameter.find("orderings") != std::string::npos) {
-        nodes[components_in_netlist].orderings =
-            get_component_orderings(parameters[indx]);
-      }
-      if (parameter.find("constants") != std::string::npos) {
-        nodes[components_in_netlist].constants =
-            get_component_constants(parameters[indx]);
-      }
-    }
-    //                 if ( nodes[components_in_netlist].type == "Entry" )
-    //                 {
-    //                     nodes[components_in_netlist].inputs.size = 1;
-    //                     if ( nodes[components_in_netlist].component_control )
-    //                     {
-    //                         nodes[components_in_netlist].inputs.input->bit_size
-    //                         = 1;
-    //                     }
-    //                     nodes[components_in_netlist].inputs.input->bit_size =
-    //                     32;
-    //                     //nodes[components_in_netlist].outputs.output->bit_size
-    //                     = 32;
-    //                 }
-
-    if (nodes[components_in_netlist].type == "Buffer" &&
-        nodes[components_in_netlist].slots == 1) {
-      if (nodes[components_in_netlist].trasparent) {
-        nodes[components_in_netlist].type = "TEHB";
+    if (node.type == "Buffer" && node.slots == 1) {
+      if (node.trasparent) {
+        node.type = "TEHB";
       } else {
-        // nodes[components_in_netlist].type = "OEHB";
+        // node.type = "OEHB";
       }
-      nodes[components_in_netlist].component_operator =
-          nodes[components_in_netlist].type;
+      node.component_operator = node.type;
     }
-    if (nodes[components_in_netlist].type == "Buffer" &&
-        nodes[components_in_netlist].slots == 2) {
-      if (nodes[components_in_netlist].trasparent) {
-        nodes[components_in_netlist].type = "tFifo";
+    if (node.type == "Buffer" && node.slots == 2) {
+      if (node.trasparent) {
+        node.type = "tFifo";
       }
-      nodes[components_in_netlist].component_operator =
-          nodes[components_in_netlist].type;
+      node.component_operator = node.type;
     }
 
-    if (nodes[components_in_netlist].type == "Fifo") {
-      if (nodes[components_in_netlist].trasparent) {
-        nodes[components_in_netlist].type = "tFifo";
+    if (node.type == "Fifo") {
+      if (node.trasparent) {
+        node.type = "tFifo";
       } else {
-        nodes[components_in_netlist].type = "nFifo";
+        node.type = "nFifo";
       }
-      nodes[components_in_netlist].component_operator =
-          nodes[components_in_netlist].type;
+      node.component_operator = node.type;
     }
 
+    node_ids.emplace(node.name, components_in_netlist);
     components_in_netlist++;
-    if (components_in_netlist >= MAX_NODES) {
-      cout << "The number of components in the netlist exceed the maximum "
-              "allowed "
-           << MAX_NODES << endl;
-    }
   }
 }
 
-void parse_line(string line) {
-  vector<string> v;
+void parse_line(string_view line) {
+  line = line.substr(0, line.find(COMMENT_CHARACTER));
 
-  line = check_comments(line);
-  string_split(line, '[', v);
+  size_t bracket = line.find('[');
+  if (bracket == string_view::npos) {
+    return;
+  }
 
-  if (v.size() > 0) {
-    int line_type = check_line(line);
-    if (line_type == COMPONENT_DESCRIPTION_LINE) {
-      parse_components(v[0], v[1]);
-    } else if (line_type == COMPONENT_CONNECTION_LINE) // is a connection line
-    {
-      parse_connections(line);
+  if (line.find("type") != string_view::npos) {
+    string_view attributes = line.substr(bracket + 1);
+    attributes = attributes.substr(0, attributes.find('['));
+    parse_components(line.substr(0, bracket), attributes);
+  } else if (line.find('>') != string_view::npos) // is a connection line
+  {
+    parse_connections(line);
+  }
+}
+
+// LSQs are numbered per thread while parsing; move the LSQs of the current
+// netlist after the 'first_lsq' ones of the files parsed elsewhere.
+void offset_lsq_indices(int first_lsq) {
+  for (int i = 0; i < components_in_netlist; i++) {
+    if (nodes[i].type == "LSQ") {
+      nodes[i].lsq_indx += first_lsq;
     }
   }
+  lsqs_in_netlist += first_lsq;
 }
 
 void parse_dot(string filename) {
 
   string input_filename = filename + ".dot";
-  ifstream inFile(input_filename);
-  string strline;
+  mapped_file inFile;
 
   components_in_netlist = 0;
+  nodes.clear();
+  node_ids.clear();
 
-  if (inFile.is_open()) {
-    while (inFile) {
-      getline(inFile, strline);
-      parse_line(strline);
+  if (inFile.open(input_filename)) {
+    const char *pos = inFile.data();
+    const char *end = pos + inFile.size();
+
+    while (pos < end) {
+      const char *eol = (const char *)memchr(pos, '\n', end - pos);
+      if (eol == 0) {
+        eol = end;
+      }
+      parse_line(string_view(pos, eol - pos));
+      pos = eol + 1;
     }
 
     inFile.close();
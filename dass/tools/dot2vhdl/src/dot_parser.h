@@ -20,43 +20,91 @@
 #include <list>
 #include <stdlib.h> /* exit, EXIT_FAILURE */
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 using namespace std;
 
 #define COMMENT_CHARACTER '/'
 
-#define MAX_INPUTS 512  // 64
-#define MAX_OUTPUTS 512 // 64
-
 #define COMPONENT_NOT_FOUND -1
 
+// Growable table indexed like the former fixed-size arrays: accessing a slot
+// past the end value-initializes the missing entries, which keeps the
+// zero-filled semantics the writer code relies on while the footprint
+// follows the actual netlist size.
+template <typename T> class dyn_array {
+public:
+  T &operator[](int indx) {
+    if (indx >= (int)items.size()) {
+      items.resize(indx + 1);
+    }
+    return items[indx];
+  }
+  int allocated() const { return items.size(); }
+  void reserve(int size) { items.reserve(size); }
+  void clear() { items.clear(); }
+
+private:
+  vector<T> items;
+};
+
+// Port type tags ("c", "l", "s", "x", "e", "a", "d", "fake", ...) come from a
+// tiny alphabet, so ports share one pooled copy of each string instead of
+// carrying their own.
+class interned_string {
+public:
+  interned_string() : str(intern(string())) {}
+  interned_string(const string &s) : str(intern(s)) {}
+  interned_string(const char *s) : str(intern(s)) {}
+
+  operator const string &() const { return *str; }
+  const string &get() const { return *str; }
+
+  bool operator==(const interned_string &other) const {
+    return str == other.str;
+  }
+  bool operator!=(const interned_string &other) const {
+    return str != other.str;
+  }
+  bool operator==(const char *s) const { return *str == s; }
+  bool operator!=(const char *s) const { return *str != s; }
+  bool operator==(const string &s) const { return *str == s; }
+  bool operator!=(const string &s) const { return *str != s; }
+
+private:
+  static const string *intern(const string &s);
+  const string *str;
+};
+
+ostream &operator<<(ostream &os, const interned_string &s);
+
 typedef struct input {
   int bit_size;
   int prev_nodes_id = COMPONENT_NOT_FOUND;
-  string type;
+  interned_string type;
   int port;
-  string info_type;
+  interned_string info_type;
 } INPUT_T;
 
 typedef struct in {
   int size;
-  INPUT_T input[MAX_OUTPUTS];
+  dyn_array<INPUT_T> input;
 } IN_T;
 
 typedef struct output {
   int bit_size;
   int next_nodes_id = COMPONENT_NOT_FOUND;
   int next_nodes_port;
-  string type;
+  interned_string type;
   int port;
-  string info_type;
+  interned_string info_type;
 
 } OUTPUT_T;
 
 typedef struct out {
   int size;
-  OUTPUT_T output[MAX_OUTPUTS];
+  dyn_array<OUTPUT_T> output;
 } OUT_T;
 
 typedef struct node {
@@ -96,13 +144,14 @@ typedef struct node {
   int constants;
 } NODE_T;
 
-#define MAX_NODES 16384 // 4096
-
 void parse_dot(string filename);
+void offset_lsq_indices(int first_lsq);
 
-extern NODE_T nodes[MAX_NODES];
+// The netlist being parsed/emitted. Each thread owns one, so that several
+// .dot files can be processed concurrently.
+extern thread_local dyn_array<NODE_T> nodes;
 
-extern int components_in_netlist;
-extern int lsqs_in_netlist;
+extern thread_local int components_in_netlist;
+extern thread_local int lsqs_in_netlist;
 
 #endif
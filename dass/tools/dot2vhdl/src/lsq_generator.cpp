@@ -21,6 +21,8 @@
 #include <list>
 #include <cctype>
 #include <sstream> 
+#include <atomic>
+#include <thread>
 
 #include "dot2vhdl.h"
 #include "dot_parser.h"
@@ -36,608 +38,175 @@ ofstream lsq_configuration_file;
 #define LSQ_DATAWIDTH_DEFAULT       32
 #define LSQ_FIFODEPTH_DEFAULT       4
 
-#define MAX_LSQ 256
+vector<LSQ_CONFIGURATION_T> lsq_conf;
 
-LSQ_CONFIGURATION_T lsq_conf[MAX_LSQ];
-
-
-#define MAX_BBs 16
-
-int bbcount;
-
-typedef struct bb_port
-{
-    int componend_id = -1;
-    int load_offset;
-    int load_port;
-    int store_offset;
-    int store_port;
-    
-}BB_PORT_T;
-
-
-typedef struct bb_st
+// What the configuration of one LSQ needs from the netlist
+typedef struct lsq_map
 {
-    int bbcount;
-    int bbId;
-    BB_PORT_T bbid[MAX_BBs];
-    int load_ports;
-    int store_ports;
+    int node_id = -1;
     
-}BB_T;
-
-BB_T bb[MAX_BBs];
+}LSQ_MAP_T;
 
+vector<LSQ_MAP_T> lsq_map;
 
-string get_lsq_name ( int lsq_indx )
-{
-    string lsq_name = "LSQ";
-    
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                lsq_name = nodes[i].name;
-                break;
-            }
-        }
-
-    }
+int lsq_datawidth;
 
-    return lsq_name;
-}
 
-int get_lsq_datawidth ()
+// Finds the node of every LSQ in one pass over the netlist.
+void map_lsqs ( void )
 {
-    int datawidth = LSQ_DATAWIDTH_DEFAULT;
+    lsq_map.assign ( lsqs_in_netlist, LSQ_MAP_T () );
+    lsq_datawidth = LSQ_DATAWIDTH_DEFAULT;
     
     for (int i = 0; i < components_in_netlist; i++) 
     {
         if ( nodes[i].name.find("load") != std::string::npos )
         {
-            datawidth = nodes[i].inputs.input[0].bit_size;
+            lsq_datawidth = nodes[i].inputs.input[0].bit_size;
         }
 
-    }
-    
-    return datawidth;
-    
-}
-
-int get_lsq_addresswidth ( int lsq_indx )
-{
-    int addresswidth = LSQ_ADDRESSWIDTH_DEFAULT;
-    
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                addresswidth = nodes[i].address_size;
-                break;
-            }
-        }
-
-#if 0
-
-        if ( nodes[i].name.find("load") != std::string::npos )
-        {
-            addresswidth = nodes[i].inputs.input[0].bit_size;
-        }
-#endif
-    }
-    
-    return addresswidth;
-}
-
-
-int get_lsq_fifo_depth ( int lsq_indx )
-{
-    int fifodepth;
-    
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-        
         if ( nodes[i].type.find("LSQ") != std::string::npos )
         {
-            if ( lsq_indx == nodes[i].lsq_indx )
+            if ( nodes[i].lsq_indx >= 0 && nodes[i].lsq_indx < lsqs_in_netlist && lsq_map[nodes[i].lsq_indx].node_id == -1 )
             {
-                fifodepth = nodes[i].fifodepth;
-                break;
+                lsq_map[nodes[i].lsq_indx].node_id = i;
             }
         }
-
-        
     }
-    
-    return fifodepth;
-
-    
-    //return LSQ_FIFODEPTH_DEFAULT; //default???
 }
 
-int get_lsq_loadPorts ( int lsq_indx )
+// Id of the node of LSQ lsq_indx in the current netlist, -1 if the LSQ
+// belongs to another input file
+int get_lsq_node ( int lsq_indx )
 {
-    int load_ports = 0;
-    for (int i = 0; i < components_in_netlist; i++) 
+    if ( lsq_indx < 0 || lsq_indx >= (int)lsq_map.size() )
     {
-#if 0
-        if ( nodes[i].component_operator == "lsq_load_op" )
-        //if ( nodes[i].name.find("load") != std::string::npos )
-        {
-            load_ports++;
-        }
-#endif
-    
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                load_ports = nodes[i].load_count;
-                break;
-            }
-        }
+        return -1;
     }
-    return load_ports;
+    return lsq_map[lsq_indx].node_id;
 }
 
-int get_lsq_storePorts ( int lsq_indx )
+string get_lsq_name ( int lsq_indx )
 {
-    int store_ports = 0;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                store_ports = nodes[i].store_count;
-                break;
-            }
-        }
+    int node_id = get_lsq_node ( lsq_indx );
 
-        
-    }
-    
-    return store_ports;
+    return ( node_id == -1 ) ? "LSQ" : nodes[node_id].name;
 }
 
-
-string get_numLoads( int lsq_indx )
+int get_lsq_datawidth ()
 {
-    string numLoads;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                numLoads = nodes[i].numLoads;
-                replace( numLoads.begin(), numLoads.end(), '{', '[' );
-                replace( numLoads.begin(), numLoads.end(), '}', ']' );
-                replace( numLoads.begin(), numLoads.end(), ';', ',' );
-                replace( numLoads.begin(), numLoads.end(), '"', ' ' );
-                break;
-            }
-        }
-
-        
-    }
-    
-    return numLoads;
-    
+    return lsq_datawidth;
 }
 
-string get_numStores( int lsq_indx )
+int get_lsq_addresswidth ( int lsq_indx )
 {
-    string numStores;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                numStores = nodes[i].numStores;
-                replace( numStores.begin(), numStores.end(), '{', '[' );
-                replace( numStores.begin(), numStores.end(), '}', ']' );
-                replace( numStores.begin(), numStores.end(), ';', ',' );
-                replace( numStores.begin(), numStores.end(), '"', ' ' );
-
-                break;
-            }
-        }
+    int node_id = get_lsq_node ( lsq_indx );
 
-        
-    }
-    
-    return numStores;
-    
+    return ( node_id == -1 ) ? LSQ_ADDRESSWIDTH_DEFAULT : nodes[node_id].address_size;
 }
 
 
-string get_loadOffset( int lsq_indx )
+int get_lsq_fifo_depth ( int lsq_indx )
 {
-    string loadOffset;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                loadOffset = nodes[i].loadOffsets;
-                replace( loadOffset.begin(), loadOffset.end(), '{', '[' );
-                replace( loadOffset.begin(), loadOffset.end(), '}', ']' );
-                replace( loadOffset.begin(), loadOffset.end(), ';', ',' );
-                replace( loadOffset.begin(), loadOffset.end(), '"', ' ' );
-                break;
-            }
-        }
+    int node_id = get_lsq_node ( lsq_indx );
 
-        
-    }
-    
+    return ( node_id == -1 ) ? 0 : nodes[node_id].fifodepth;
     
-    return loadOffset;
+    //return LSQ_FIFODEPTH_DEFAULT; //default???
 }
 
-string get_storeOffset( int lsq_indx )
+int get_lsq_loadPorts ( int lsq_indx )
 {
-    string storeOffset;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                storeOffset = nodes[i].storeOffsets;
-                replace( storeOffset.begin(), storeOffset.end(), '{', '[' );
-                replace( storeOffset.begin(), storeOffset.end(), '}', ']' );
-                replace( storeOffset.begin(), storeOffset.end(), ';', ',' );
-                replace( storeOffset.begin(), storeOffset.end(), '"', ' ' );
-
-                break;
-            }
-        }
+    int node_id = get_lsq_node ( lsq_indx );
 
-        
-    }
-    
-    return storeOffset;
+    return ( node_id == -1 ) ? 0 : nodes[node_id].load_count;
 }
 
-
-string get_loadPorts( int lsq_indx )
+int get_lsq_storePorts ( int lsq_indx )
 {
-    string loadPorts;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                loadPorts = nodes[i].loadPorts;
-                replace( loadPorts.begin(), loadPorts.end(), '{', '[' );
-                replace( loadPorts.begin(), loadPorts.end(), '}', ']' );
-                replace( loadPorts.begin(), loadPorts.end(), ';', ',' );
-                replace( loadPorts.begin(), loadPorts.end(), '"', ' ' );
-
-                break;
-            }
-        }
+    int node_id = get_lsq_node ( lsq_indx );
 
-        
-    }
-    
-    return loadPorts;
-    
+    return ( node_id == -1 ) ? 0 : nodes[node_id].store_count;
 }
 
-string get_storePorts( int lsq_indx )
+int get_lsq_bbcount ( int lsq_indx )
 {
-    string storePorts;
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
+    int node_id = get_lsq_node ( lsq_indx );
 
-#if 0
-        //if ( nodes[i].name.find("store") != std::string::npos )
-        if ( nodes[i].component_operator == "lsq_store_op" )
-        {
-            store_ports++;
-        }
-#endif        
-        
-        if ( nodes[i].type.find("LSQ") != std::string::npos )
-        {
-            if ( lsq_indx == nodes[i].lsq_indx )
-            {
-                storePorts = nodes[i].storePorts;
-                replace( storePorts.begin(), storePorts.end(), '{', '[' );
-                replace( storePorts.begin(), storePorts.end(), '}', ']' );
-                replace( storePorts.begin(), storePorts.end(), ';', ',' );
-                replace( storePorts.begin(), storePorts.end(), '"', ' ' );
-
-                break;
-            }
-        }
-
-        
-    }
-    
-    return storePorts;
-    
+    return ( node_id == -1 ) ? 0 : nodes[node_id].bbcount;
 }
 
-#define INVALID_BB_COUNT -1
-
-
-int get_lsq_loadSizes( int indx )
+// The dot file writes the LSQ lists as {a; b}, the generator wants [a, b]
+string get_json_list ( string list )
 {
-
-//     //int bbcount;
-//     for (int i = 0; i < components_in_netlist; i++) 
-//     {
-//     
-//         if ( nodes[i].bbId != INVALID_BB_COUNT )
-//         {
-//             
-//             cout << "bbId" << nodes[i].bbId << " " << nodes[i].name << "  nodes[i].portId " << nodes[i].portId << "  nodes[i].offset " << nodes[i].offset << endl;
-//         }
-//     }
-    
-    return 1;
+    replace( list.begin(), list.end(), '{', '[' );
+    replace( list.begin(), list.end(), '}', ']' );
+    replace( list.begin(), list.end(), ';', ',' );
+    replace( list.begin(), list.end(), '"', ' ' );
+    return list;
 }
 
-int get_lsq_loadOffsets( int indx )
+string get_numLoads( int lsq_indx )
 {
-    return 1;
-    
-}
+    int node_id = get_lsq_node ( lsq_indx );
 
-int get_lsq_loadPortsList( int indx )
-{
-    return 1;
-    
+    return ( node_id == -1 ) ? "" : get_json_list ( nodes[node_id].numLoads );
 }
 
-int get_lsq_storeSizes( int indx )
+string get_numStores( int lsq_indx )
 {
+    int node_id = get_lsq_node ( lsq_indx );
 
-    return 1;
+    return ( node_id == -1 ) ? "" : get_json_list ( nodes[node_id].numStores );
 }
 
-
-int get_lsq_storeOffsets( int indx )
+string get_loadOffset( int lsq_indx )
 {
-    return 1;
-    
-}
-
+    int node_id = get_lsq_node ( lsq_indx );
 
-int get_lsq_storePortsList( int indx )
-{
-    return 1;
-    
+    return ( node_id == -1 ) ? "" : get_json_list ( nodes[node_id].loadOffsets );
 }
 
-
-int get_bbindx ( int bbId )
+string get_storeOffset( int lsq_indx )
 {
-    
-    static int return_indx = 0;
-    
-    for (int indx = 0; indx < MAX_BBs; indx++) 
-    {
-        if ( bb[indx].bbId ==  bbId )
-        {
-            return indx;
-        }
-        else // means not found yet 
-        {
-            bb[indx].bbId = bbId;
-        }
-    }
-    
-    return return_indx++;
+    int node_id = get_lsq_node ( lsq_indx );
+
+    return ( node_id == -1 ) ? "" : get_json_list ( nodes[node_id].storeOffsets );
 }
 
-void map_bb ( int lsq_indx )
+string get_loadPorts( int lsq_indx )
 {
-    int bbIdindx_load = 0;
-    int bbIdindx_store = 0;
-    int bbindx = 0;
-    
-    for (int i = 0; i < components_in_netlist; i++) 
-    {
-        if ( nodes[i].name.find("LSQ") != std::string::npos )
-        {
-            if ( nodes[i].lsq_indx == lsq_indx )
-            {
-                bbcount = nodes[i].bbcount;    
-            }
-        }
-        if ( nodes[i].bbId != INVALID_BB_COUNT )
-        {
-//             bb[nodes[i].bbId].bbid[bbIdindx].componend_id = i;
-//             
-//             if ( nodes[i].name.find("store") != std::string::npos )
-//             {
-//                 bb[nodes[i].bbId].store_ports++;
-//             }
-//             if ( nodes[i].name.find("load") != std::string::npos )
-//             {
-//                 bb[nodes[i].bbId].load_ports++;
-//             }
-//         
-//             bbIdindx++;
-
-            //indexes from 0
-            
-            bbindx = get_bbindx ( nodes[i].bbId );
-            
-            
-            //if ( nodes[i].name.find("store") != std::string::npos )
-            if ( nodes[i].component_operator == "lsq_store_op" )
-            {
-                bb[bbindx].store_ports++;
-              //  cout << " component id " << i << " bbindx" << bbindx << " bbIdindx_store " << bbIdindx_store << " node offset " << nodes[i].offset << endl;
-              //  cout << " component id " << i << " bbindx" << bbindx << " bbIdindx_store " << bbIdindx_store << " node portId " << nodes[i].portId << endl;
-                bb[bbindx].bbid[bbIdindx_store].store_offset = nodes[i].offset;
-                bb[bbindx].bbid[bbIdindx_store].store_port = nodes[i].portId;
-                bb[bbindx].bbid[bbIdindx_store].componend_id = i;
-
-                bbIdindx_store++;
-            }
-            //if ( nodes[i].name.find("load") != std::string::npos )
-            if ( nodes[i].component_operator == "lsq_load_op" )
+    int node_id = get_lsq_node ( lsq_indx );
 
-            {
-                bb[bbindx].load_ports++;
-                //cout << " component id " << i << " bbindx " << bbindx << " bbIdindx_load " << bbIdindx_load << " node offset " << nodes[i].offset << endl;
-                //cout << " component id " << i << " bbindx " << bbindx << " bbIdindx_load " << bbIdindx_load << " node portId " << nodes[i].portId << endl;
-
-                bb[bbindx].bbid[bbIdindx_load].load_offset = nodes[i].offset;
-                bb[bbindx].bbid[bbIdindx_load].load_port = nodes[i].portId;
-                bb[bbindx].bbid[bbIdindx_load].componend_id = i;
+    return ( node_id == -1 ) ? "" : get_json_list ( nodes[node_id].loadPorts );
+}
 
-                bbIdindx_load++;
-            }
+string get_storePorts( int lsq_indx )
+{
+    int node_id = get_lsq_node ( lsq_indx );
 
-            //bbIdindx++;
-            //bbindx++;
-            //bb[bbindx].bbcount = bbIdindx;
-            
-        }
-    }
-    
-//     for (int indx = 0; indx < MAX_BBs; indx++) 
-//     {
-//         for (int indx2 = 0; indx2 < MAX_BBs; indx2++) 
-//         {
-//             if ( bb[indx].bbid[indx2].componend_id != -1 )
-//             {
-//                 cout <<  "bb[" << indx << "] " << " component_id " << bb[indx].bbid[indx2].componend_id << endl;
-//             }
-//         }
-//         //if ( bb[indx].store_ports != 0 || bb[indx].load_ports != 0 )
-//         {
-//             cout <<  "bb[" << indx << "] store_ports " <<  bb[indx].store_ports << endl;
-//             cout <<  "bb[" << indx << "] load_ports " <<  bb[indx].load_ports << endl;
-// 
-//             for (int indx3 = 0; indx3 < 4; indx3++) 
-//             {
-//                 cout <<  "bb[" << indx << "] load_offset [" << indx3 << " ] "<< bb[indx].bbid[indx3].load_offset << endl;
-//                 cout <<  "bb[" << indx << "] store_offset[" << indx3 << " ] "<< bb[indx].bbid[indx3].store_offset << endl;
-//                 cout <<  "bb[" << indx << "] load_port [" << indx3 << " ] "<< bb[indx].bbid[indx3].load_port << endl;
-//                 cout <<  "bb[" << indx << "] store_port [" << indx3 << " ] "<< bb[indx].bbid[indx3].store_port << endl;
-//             }
-// 
-//         }
-//     }
+    return ( node_id == -1 ) ? "" : get_json_list ( nodes[node_id].storePorts );
 }
 
 void lsq_set_configuration ( int lsq_indx )
 {
     
-    map_bb ( lsq_indx );
-    
     lsq_conf[lsq_indx].name = get_lsq_name ( lsq_indx );
     lsq_conf[lsq_indx].dataWidth = get_lsq_datawidth ();//     "dataWidth": 32,
     lsq_conf[lsq_indx].addressWidth = get_lsq_addresswidth ( lsq_indx );//     "addressWidth": 10,
     lsq_conf[lsq_indx].fifoDepth = get_lsq_fifo_depth ( lsq_indx );    //     "fifoDepth": 4,
     lsq_conf[lsq_indx].loadPorts = get_lsq_loadPorts( lsq_indx ); //     "loadPorts": 1,
     lsq_conf[lsq_indx].storePorts = get_lsq_storePorts( lsq_indx ); //     "storePorts": 1,
-
-    for (int indx = 0; indx < MAX_SIZES; indx++ )
-    {
-        for (int indx2 = 0; indx2 < bb[indx].bbcount; indx2++ )
-        {
-            lsq_conf[lsq_indx].bbParams.loadSizes[indx2] = bb[indx].load_ports;
-            lsq_conf[lsq_indx].bbParams.storeSizes[indx2] = bb[indx].store_ports;            
-        }
-    }
-    
-//     for (int indx = 0; indx < MAX_SIZES; indx++ )
-//     {
-//         lsq_conf.bbParams.loadSizes[indx] = get_lsq_loadSizes(indx);
-//         lsq_conf.bbParams.storeSizes[indx] = get_lsq_storeSizes(indx);
-//         lsq_conf.bbParams.loadOffsets[indx] = get_lsq_loadOffsets(indx);
-//         lsq_conf.bbParams.storeOffsets[indx] = get_lsq_storeOffsets(indx);
-//         lsq_conf.bbParams.loadPortsList[indx] = get_lsq_loadPortsList(indx);
-//         lsq_conf.bbParams.storePortsList[indx] = get_lsq_storePortsList(indx);
-//         
-//     }
+    lsq_conf[lsq_indx].numBBs = get_lsq_bbcount ( lsq_indx );
     
 }
 
-void lsq_write_configuration_file ( string top_level_filename, int lsq_indx )
+// LSQs of the design the generator is run on
+vector<int> lsqs_to_generate;
+
+// Writes the "specifications" entry of one LSQ
+void lsq_write_specification ( ostream &lsq_configuration_file, int lsq_indx )
 {
-    string lsq_filename;
-    
-    lsq_filename = top_level_filename;
-    lsq_filename += "_lsq";
-    lsq_filename += to_string(lsq_indx);
-    lsq_filename +="_configuration.json";
-    
-    lsq_configuration_file.open ( lsq_filename );
-    
-    lsq_configuration_file << "{" << endl;
-    lsq_configuration_file << "\"specifications\" :[" << endl;
     lsq_configuration_file << "{" << endl;
     
     lsq_configuration_file << "\"name\": \""            << lsq_conf[lsq_indx].name              << "\", "<< endl;
@@ -651,141 +220,9 @@ void lsq_write_configuration_file ( string top_level_filename, int lsq_indx )
     lsq_configuration_file << "\"numStorePorts\":"      << lsq_conf[lsq_indx].storePorts        << ", "<< endl;
     //lsq_configuration_file << "\"bbParams\":"        <<  "{"                       << endl;
 
-    lsq_configuration_file << "\"numBBs\": "<< bbcount << "," << endl;
-    
-
-#if 0    
-    lsq_configuration_file << "\"numLoads\": [" ;
-    
-    for (int indx2 = 0; indx2 < bbcount; indx2++ )
-    {
-        if ( indx2 != 0 )
-        {
-
-            lsq_configuration_file << ", ";
-
-        }
-        
-        lsq_configuration_file << bb[indx2].load_ports;
-
-    }
-
-    lsq_configuration_file << "]," << endl;
-
-
-    lsq_configuration_file << "\"numStores\": [" ;
-    
-    for (int indx2 = 0; indx2 < bbcount; indx2++ )
-    {
-        if ( indx2 != 0 )
-        {
-            lsq_configuration_file << ", ";
-        }
-        lsq_configuration_file << bb[indx2].store_ports;
-    }
-    lsq_configuration_file << "]," << endl;
-    
-
-//    lsq_configuration_file << "\"loadOffsets\":"     << "[[0, 0, 0, 0]],"          << endl;
-
-    lsq_configuration_file << "\"loadOffsets\": [";
-    
-    for (int indx2 = 0; indx2 < bbcount; indx2++ )
-    {
-        if ( indx2 != 0 )
-        {
-            lsq_configuration_file << ", ";
-        }
-
-        lsq_configuration_file << "[";
-        for (int indx3 = 0; indx3 < lsq_conf[lsq_indx].fifoDepth; indx3++ )
-        {
-            if ( indx3 != 0 )
-            {
-                lsq_configuration_file << ", ";
-            }
-            lsq_configuration_file << bb[indx2].bbid[indx3].load_offset;
-        }
-        lsq_configuration_file << "]";
-
-    }
-    lsq_configuration_file << "]," << endl;
-    
-
-
-    lsq_configuration_file << "\"storeOffsets\": [";
-    
-    for (int indx2 = 0; indx2 < bbcount; indx2++ )
-    {
-        if ( indx2 != 0 )
-        {
-            lsq_configuration_file << ", ";
-        }
-
-        lsq_configuration_file << "[";
-        for (int indx3 = 0; indx3 < lsq_conf[lsq_indx].fifoDepth; indx3++ )
-        {
-            if ( indx3 != 0 )
-            {
-                lsq_configuration_file << ", ";
-            }
-            lsq_configuration_file << bb[indx2].bbid[indx3].store_offset;
-        }
-        lsq_configuration_file << "]";
-    }
-    lsq_configuration_file << "]," << endl;
-    
+    lsq_configuration_file << "\"numBBs\": "<< lsq_conf[lsq_indx].numBBs << "," << endl;
     
 
-    lsq_configuration_file << "\"loadPorts\": [";
-    
-    for (int indx2 = 0; indx2 < bbcount; indx2++ )
-    {
-        if ( indx2 != 0 )
-        {
-            lsq_configuration_file << ", ";
-        }
-
-        lsq_configuration_file << "[";
-        for (int indx3 = 0; indx3 < lsq_conf[lsq_indx].fifoDepth; indx3++ )
-        {
-            if ( indx3 != 0 )
-            {
-                lsq_configuration_file << ", ";
-            }
-            lsq_configuration_file << bb[indx2].bbid[indx3].load_port;
-        }
-        lsq_configuration_file << "]";
-    }
-
-    lsq_configuration_file << "]," << endl;
-
-
-
-
-    lsq_configuration_file << "\"storePorts\": [";
-    
-    for (int indx2 = 0; indx2 < bbcount; indx2++ )
-    {
-        if ( indx2 != 0 )
-        {
-            lsq_configuration_file << ", ";
-        }
-
-        lsq_configuration_file << "[";
-        for (int indx3 = 0; indx3 < lsq_conf[lsq_indx].fifoDepth; indx3++ )
-        {
-            if ( indx3 != 0 )
-            {
-                lsq_configuration_file << ", ";
-            }
-            lsq_configuration_file << bb[indx2].bbid[indx3].store_port;
-        }
-        lsq_configuration_file << "]";
-    }
-
-    lsq_configuration_file << "]" << endl;
-#endif
     
     lsq_configuration_file << "\"numLoads\": " << get_numLoads( lsq_indx ) << "," << endl;
     lsq_configuration_file << "\"numStores\": " << get_numStores( lsq_indx ) << "," << endl;
@@ -800,10 +237,6 @@ void lsq_write_configuration_file ( string top_level_filename, int lsq_indx )
     
     //lsq_configuration_file << "}" << endl;
     lsq_configuration_file << "}" << endl;
-    lsq_configuration_file << "]" << endl;
-    lsq_configuration_file << "}" << endl;
-    
-    lsq_configuration_file.close();
     
 
 // {
@@ -829,10 +262,44 @@ void lsq_write_configuration_file ( string top_level_filename, int lsq_indx )
     
 }
 
+void lsq_write_configuration_file ( string top_level_filename, int lsq_indx )
+{
+    string lsq_filename;
+    stringstream specification;
+    
+    lsq_filename = top_level_filename;
+    lsq_filename += "_lsq";
+    lsq_filename += to_string(lsq_indx);
+    lsq_filename +="_configuration.json";
+    
+    lsq_write_specification ( specification, lsq_indx );
+
+    // LSQs of the other input files are not in this netlist: their
+    // specification only holds defaults.
+    if ( get_lsq_node ( lsq_indx ) != -1 )
+    {
+        lsqs_to_generate.push_back ( lsq_indx );
+    }
+
+    lsq_configuration_file.open ( lsq_filename );
+    
+    lsq_configuration_file << "{" << endl;
+    lsq_configuration_file << "\"specifications\" :[" << endl;
+    lsq_configuration_file << specification.str();
+    lsq_configuration_file << "]" << endl;
+    lsq_configuration_file << "}" << endl;
+    
+    lsq_configuration_file.close();
+}
+
 void lsq_generate_configuration ( string top_level_filename )
 {
+    lsqs_to_generate.clear();
+    lsq_conf.assign ( lsqs_in_netlist, LSQ_CONFIGURATION_T () );
+
+    map_lsqs ();
     
-    for ( int lsq_indx; lsq_indx < lsqs_in_netlist; lsq_indx++ )
+    for ( int lsq_indx = 0; lsq_indx < lsqs_in_netlist; lsq_indx++ )
     {    
         lsq_set_configuration ( lsq_indx );
         lsq_write_configuration_file( top_level_filename, lsq_indx );
@@ -840,49 +307,84 @@ void lsq_generate_configuration ( string top_level_filename )
 }
 
 
-void lsq_generate ( string top_level_filename )
+// Runs the generator on the specification of one LSQ and returns its output
+string lsq_run_generator ( string top_level_filename, int lsq_indx )
 {
     
     FILE *fp;
     char path[1035];
-    stringstream ss_path, string_path;
+    stringstream output;
     
     char cmd[512];
        
-    //int lsq_indx;
+    //sprintf ( cmd, "java -jar -Xmx7G lsq.jar --target-dir %s --spec-file %s.json", top_level_filename.c_str(), top_level_filename.c_str() );
+    //sprintf ( cmd, "java -jar -Xmx7G lsq.jar --target-dir . --spec-file %s_lsq%d_configuration.json",  top_level_filename.c_str(), lsq_indx );
+    //sprintf ( cmd, "java -jar -Xmx7G /home/dynamatic/Dynamatic/bin/lsq.jar --target-dir . --spec-file %s_lsq%d_configuration.json",  top_level_filename.c_str(), lsq_indx );
+    
+    snprintf ( cmd, sizeof(cmd), "lsq_generate %s_lsq%d_configuration.json",  top_level_filename.c_str(), lsq_indx );
+    
+    output << "Generating LSQ " << lsq_indx << " component..." << endl;
+    output << cmd << endl;
 
-    for ( int lsq_indx; lsq_indx < lsqs_in_netlist; lsq_indx++ )
-    {    
+    /* Open the command for reading. */
+    fp = popen( cmd, "r" );
+    if (fp == NULL) 
+    {
+        return output.str();
+    }
 
-        cout << "Generating LSQ " << lsq_indx << " component..." << endl;
+    /* Read the output a line at a time - output it. */
+    while (fgets(path, sizeof(path)-1, fp) != NULL) 
+    {
+        output << path;
+    }
 
-        //sprintf ( cmd, "java -jar -Xmx7G lsq.jar --target-dir %s --spec-file %s.json", top_level_filename.c_str(), top_level_filename.c_str() );
-        //sprintf ( cmd, "java -jar -Xmx7G lsq.jar --target-dir . --spec-file %s_lsq%d_configuration.json",  top_level_filename.c_str(), lsq_indx );
-        //sprintf ( cmd, "java -jar -Xmx7G /home/dynamatic/Dynamatic/bin/lsq.jar --target-dir . --spec-file %s_lsq%d_configuration.json",  top_level_filename.c_str(), lsq_indx );
-        
-        sprintf ( cmd, "lsq_generate %s_lsq%d_configuration.json",  top_level_filename.c_str(), lsq_indx );
-        
+    /* close */
+    pclose(fp);    
     
-        cout << cmd << endl;
+    return output.str();
+}
 
-        /* Open the command for reading. */
-        fp = popen( cmd, "r" );
-        if (fp == NULL) 
-        {
-            return;
-        }
+// The LSQs are independent: the generator runs of all of them are spread
+// over a pool of threads, and their outputs are printed in LSQ order once
+// they are all done.
+void lsq_generate ( string top_level_filename )
+{
+    int lsq_count = lsqs_to_generate.size();
+    vector<string> outputs ( lsq_count );
+    atomic<int> next_lsq ( 0 );
+    vector<thread> workers;
 
-        /* Read the output a line at a time - output it. */
-        while (fgets(path, sizeof(path)-1, fp) != NULL) 
+    int threads = thread::hardware_concurrency ();
+    if ( threads < 1 )
+    {
+        threads = 1;
+    }
+    if ( threads > lsq_count )
+    {
+        threads = lsq_count;
+    }
+
+    for ( int worker = 0; worker < threads; worker++ )
+    {
+        workers.emplace_back ( [&] ()
         {
-            printf("%s", path);
-        }
+            int indx;
+            while ( ( indx = next_lsq++ ) < lsq_count )
+            {
+                outputs[indx] = lsq_run_generator ( top_level_filename, lsqs_to_generate[indx] );
+            }
+        } );
+    }
 
-        /* close */
-        pclose(fp);    
-        
-        //cout << "Generating LSQ component..." << endl;
+    for ( auto &worker : workers )
+    {
+        worker.join ();
+    }
 
+    for ( auto &output : outputs )
+    {
+        cout << output;
     }
 }
 
@@ -16,20 +16,6 @@
 void lsq_generate_configuration ( string top_level_filename );
 void lsq_generate ( string top_level_filename );
 
-#define MAX_SIZES   16
-typedef struct bb_params
-{
-
-    int loadSizes[MAX_SIZES];//     "loadSizes": [1],
-    int storeSizes[MAX_SIZES];//     "storeSizes": [1],
-    int loadOffsets[MAX_SIZES];//     "loadOffsets": [[0, 0, 0, 0]],
-    int storeOffsets[MAX_SIZES];//     "storeOffsets": [[1, 0, 0, 0]],
-    int loadPortsList[MAX_SIZES];//     "loadPortsList": [[0, 0, 0, 1]],
-    int storePortsList[MAX_SIZES];//     "storePortsList": [[0, 0, 0, 0]]
-
-    
-} BB_PARAMS_T;
-
 typedef struct lsq_configuration
 {
     string name;    //     "name": "hist",
@@ -38,7 +24,7 @@ typedef struct lsq_configuration
     int fifoDepth;    //     "fifoDepth": 4,
     int loadPorts;//     "loadPorts": 1,
     int storePorts;//     "storePorts": 1,
-    BB_PARAMS_T bbParams;//     "bbParams": {
+    int numBBs;
 
 } LSQ_CONFIGURATION_T;
 
@@ -20,8 +20,13 @@
 #include "vhdl_writer.h"
 #include "eda_if.h"
 #include "lsq_generator.h"
+#include "sys_utils.h"
 
 #include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -42,5 +47,51 @@ void signal_handler ( void )
     signal(SIGTERM, signalhand);  
 }
 
+mapped_file::~mapped_file ( )
+{
+    close ( );
+}
+
+bool mapped_file::open ( const string &filename )
+{
+    close ( );
+
+    int fd = ::open ( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        return false;
+    }
 
+    struct stat st;
+    if ( fstat ( fd, &st ) < 0 )
+    {
+        ::close ( fd );
+        return false;
+    }
 
+    if ( st.st_size > 0 )
+    {
+        void *addr = mmap ( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( addr == MAP_FAILED )
+        {
+            ::close ( fd );
+            return false;
+        }
+        madvise ( addr, st.st_size, MADV_SEQUENTIAL );
+        base = (const char *) addr;
+        length = st.st_size;
+    }
+
+    ::close ( fd );
+    return true;
+}
+
+void mapped_file::close ( void )
+{
+    if ( base != 0 )
+    {
+        munmap ( (void *) base, length );
+    }
+    base = 0;
+    length = 0;
+}
@@ -14,7 +14,32 @@
 #ifndef _SYS_UTIL_
 #define _SYS_UTIL_
 
+#include <string>
+
+using namespace std;
 
 void signal_handler ( void );
 
+// Read-only view of a whole input file, memory-mapped so parsers can
+// tokenize it in place without copying it line by line.
+class mapped_file
+{
+public:
+    mapped_file ( ) : base ( 0 ), length ( 0 ) { }
+    ~mapped_file ( );
+
+    bool open ( const string &filename );
+    void close ( void );
+
+    const char *data ( void ) const { return base; }
+    size_t size ( void ) const { return length; }
+
+private:
+    mapped_file ( const mapped_file & );
+    mapped_file &operator= ( const mapped_file & );
+
+    const char *base;
+    size_t length;
+};
+
 #endif
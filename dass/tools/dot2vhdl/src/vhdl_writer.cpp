@@ -16,6 +16,8 @@
 #include <iostream>
 #include <list>
 #include <math.h>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -86,7 +88,10 @@ typedef struct component {
 
 COMPONENT_T components_type[MAX_COMPONENTS];
 
-ofstream netlist;
+// The VHDL of the netlist being emitted is assembled in memory and written
+// out in one go by write_vhdl, so the many endl below never reach the disk
+// one line at a time. One buffer per thread, like the netlist itself.
+static thread_local stringstream netlist;
 ofstream tb_wrapper;
 
 void write_signals() {
@@ -1096,18 +1101,25 @@ string get_component_entity(string component, int component_id) {
   return component_entity;
 }
 
-int get_memory_inputs(int node_id) {
+// Number of "e" (memory completion) inputs of each node, filled once per
+// netlist by index_netlist(). The port loops of write_components ask for it
+// on every port, so recounting there made wide Exit nodes quadratic.
+static thread_local vector<int> memory_inputs;
 
-  int memory_inputs = nodes[node_id].inputs.size;
-  for (int indx = 0; indx < nodes[node_id].inputs.size; indx++) {
-    if (nodes[node_id].inputs.input[indx].type != "e") {
-      memory_inputs--;
+void index_netlist(void) {
+  memory_inputs.assign(components_in_netlist, 0);
+
+  for (int i = 0; i < components_in_netlist; i++) {
+    for (int indx = 0; indx < nodes[i].inputs.size; indx++) {
+      if (nodes[i].inputs.input[indx].type == "e") {
+        memory_inputs[i]++;
+      }
     }
   }
-
-  return memory_inputs;
 }
 
+int get_memory_inputs(int node_id) { return memory_inputs[node_id]; }
+
 string get_generic(int node_id) {
   string generic;
 
@@ -1533,11 +1545,11 @@ void write_components() {
     //         else
     if (nodes[i].type == "LSQ" || nodes[i].type == "MC") {
 
-      static int load_indx = 0;
+      static thread_local int load_indx = 0;
       load_indx = 0;
 
-      static int store_add_indx = 0;
-      static int store_data_indx = 0;
+      static thread_local int store_add_indx = 0;
+      static thread_local int store_data_indx = 0;
       store_add_indx = 0;
       store_data_indx = 0;
 
@@ -2277,7 +2289,7 @@ void write_components() {
         } else if (nodes[i].outputs.output[lsq_indx].type == "s") {
           // LANA REMOVE???
           netlist << COMMA << endl;
-          static int store_indx = 0;
+          static thread_local int store_indx = 0;
 
           input_port = "io";
           input_port += UNDERSCORE;
@@ -2324,7 +2336,7 @@ void write_components() {
         } else if (nodes[i].outputs.output[lsq_indx].type == "e") {
 
           // netlist << COMMA << endl;
-          static int store_indx = 0;
+          static thread_local int store_indx = 0;
 
           input_port = "io";
           input_port += UNDERSCORE;
@@ -3224,10 +3236,20 @@ void write_entity(string filename, int indx) {
   }
 }
 
+// Same format as ctime, but formatted in a local buffer since the files are
+// written concurrently
+static string get_creation_time() {
+  time_t now = time(0);
+  struct tm local;
+  char dt[64];
+  localtime_r(&now, &local);
+  strftime(dt, sizeof(dt), "%a %b %e %H:%M:%S %Y\n", &local);
+  return dt;
+}
+
 void write_intro() {
 
-  time_t now = time(0);
-  char *dt = ctime(&now);
+  string dt = get_creation_time();
 
   netlist << "-- =============================================================="
           << endl;
@@ -3245,12 +3267,7 @@ void write_intro() {
           << endl;
 }
 
-void vhdl_writer::write_vhdl(string filename, int indx) {
-
-  string entity = clean_entity(filename);
-
-  string output_filename = filename + ".vhd";
-
+static void init_components_type(void) {
   components_type[COMPONENT_GENERIC].in_ports = 2;
   components_type[COMPONENT_GENERIC].out_ports = 1;
   components_type[COMPONENT_GENERIC].in_ports_name_str = in_ports_name_generic;
@@ -3268,8 +3285,21 @@ void vhdl_writer::write_vhdl(string filename, int indx) {
       out_ports_name_generic;
   components_type[COMPONENT_CONSTANT].out_ports_type_str =
       out_ports_type_generic;
+}
 
-  netlist.open(output_filename);
+void vhdl_writer::write_vhdl(string filename, int indx) {
+  static once_flag components_type_ready;
+
+  string entity = clean_entity(filename);
+
+  string output_filename = filename + ".vhd";
+
+  call_once(components_type_ready, init_components_type);
+
+  index_netlist();
+
+  netlist.str("");
+  netlist.clear();
 
   write_intro();
 
@@ -3287,13 +3317,16 @@ void vhdl_writer::write_vhdl(string filename, int indx) {
 
   netlist << endl << "end behavioral; " << endl;
 
-  netlist.close();
+  ofstream outFile(output_filename);
+  outFile << netlist.rdbuf();
+  outFile.close();
+
+  netlist.str("");
 }
 
 void write_tb_intro() {
 
-  time_t now = time(0);
-  char *dt = ctime(&now);
+  string dt = get_creation_time();
 
   tb_wrapper
       << "-- =============================================================="